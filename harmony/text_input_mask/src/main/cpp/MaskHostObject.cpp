@@ -0,0 +1,68 @@
+#include "MaskHostObject.h"
+#include "RNTextInputMask.h"
+
+using namespace facebook;
+using namespace TinpMask;
+
+namespace rnoh {
+
+static const char *const PROPERTY_NAMES[] = {"apply", "unmask", "placeholder", "acceptableTextLength",
+                                             "totalValueLength"};
+
+MaskHostObject::MaskHostObject(std::shared_ptr<Mask> mask, bool autocomplete)
+    : mask(std::move(mask)), autocomplete(autocomplete) {}
+
+const Result &MaskHostObject::apply(jsi::Runtime &rt, const jsi::Value *args, size_t count) {
+    std::string value = args[0].getString(rt).utf8(rt);
+    bool useAutocomplete = count > 1 && args[1].isBool() ? args[1].getBool() : autocomplete;
+    CaretString text(value, value.length(), forwardGravity(useAutocomplete));
+    return mask->apply(text, session);
+}
+
+jsi::Value MaskHostObject::get(jsi::Runtime &rt, const jsi::PropNameID &name) {
+    // 方法闭包持有 self，即使句柄先被回收，已取出的方法仍然有效
+    auto self = shared_from_this();
+    std::string property = name.utf8(rt);
+    if (property == "apply" || property == "unmask") {
+        bool extract = property == "unmask";
+        return jsi::Function::createFromHostFunction(
+            rt, name, 2,
+            [self, extract](jsi::Runtime &runtime, const jsi::Value &, const jsi::Value *args,
+                            size_t count) -> jsi::Value {
+                if (count < 1 || !args[0].isString()) {
+                    throw jsi::JSError(runtime, "expected a string value");
+                }
+                const Result &result = self->apply(runtime, args, count);
+                return makeJSString(runtime, extract ? result.extractedValue : result.formattedText.string);
+            });
+    }
+    if (property == "placeholder") {
+        return jsi::Function::createFromHostFunction(
+            rt, name, 0, [self](jsi::Runtime &runtime, const jsi::Value &, const jsi::Value *, size_t) -> jsi::Value {
+                return makeJSString(runtime, self->mask->placeholder());
+            });
+    }
+    if (property == "acceptableTextLength") {
+        return jsi::Function::createFromHostFunction(
+            rt, name, 0, [self](jsi::Runtime &, const jsi::Value &, const jsi::Value *, size_t) -> jsi::Value {
+                return jsi::Value(self->mask->acceptableTextLength());
+            });
+    }
+    if (property == "totalValueLength") {
+        return jsi::Function::createFromHostFunction(
+            rt, name, 0, [self](jsi::Runtime &, const jsi::Value &, const jsi::Value *, size_t) -> jsi::Value {
+                return jsi::Value(self->mask->totalValueLength());
+            });
+    }
+    return jsi::Value::undefined();
+}
+
+std::vector<jsi::PropNameID> MaskHostObject::getPropertyNames(jsi::Runtime &rt) {
+    std::vector<jsi::PropNameID> names;
+    for (const char *property : PROPERTY_NAMES) {
+        names.push_back(jsi::PropNameID::forAscii(rt, property));
+    }
+    return names;
+}
+
+} // namespace rnoh
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <jsi/jsi.h>
+#include <memory>
+#include "common/ApplySession.h"
+#include "common/Mask.h"
+
+namespace rnoh {
+
+/**
+ * JS handle to a compiled mask, returned by ``compileMask``.
+ *
+ * Owns a shared ``Mask`` (or ``RTLMask``) so the format is compiled once and stays alive for as
+ * long as JS holds the handle. Exposes `apply`, `unmask`, `placeholder`, `acceptableTextLength`
+ * and `totalValueLength`.
+ *
+ * Handles are only used from the JS thread; consecutive `apply`/`unmask` calls share one
+ * ``ApplySession`` and only rescan the input past the common prefix with the previous call.
+ */
+class MaskHostObject : public facebook::jsi::HostObject, public std::enable_shared_from_this<MaskHostObject> {
+public:
+    MaskHostObject(std::shared_ptr<TinpMask::Mask> mask, bool autocomplete);
+
+    facebook::jsi::Value get(facebook::jsi::Runtime &rt, const facebook::jsi::PropNameID &name) override;
+    std::vector<facebook::jsi::PropNameID> getPropertyNames(facebook::jsi::Runtime &rt) override;
+
+private:
+    // 对 args[0] 应用掩码；args[1] 可覆盖默认的 autocomplete
+    const TinpMask::Result &apply(facebook::jsi::Runtime &rt, const facebook::jsi::Value *args, size_t count);
+
+    std::shared_ptr<TinpMask::Mask> mask;
+    bool autocomplete; // compileMask 选项中的默认值
+    TinpMask::ApplySession session;
+};
+
+} // namespace rnoh
@@ -1,22 +1,25 @@
 #include "RNTextInputMask.h"
+#include "MaskHostObject.h"
 #include "RNOH/arkui/TextInputNode.h"
 #include "RNOH/ComponentInstance.h"
 #include "RNOH/RNInstanceCAPI.h"
 #include "RNOHCorePackage/ComponentInstances/TextInputComponentInstance.h"
 #include "common/model/AffinityCalculationStrategy.h"
+#include "common/model/TextOffsets.h"
+#include <ReactCommon/TurboModuleUtils.h>
 
+#include <algorithm>
 #include <cstdint>
-#include <iostream>
+#include <cstring>
 #include <jsi/jsi.h>
 #include <string>
+#include <string_view>
 
 using namespace facebook;
 using namespace rnoh;
 using namespace react;
 using namespace TinpMask;
 static constexpr int AVOIDENCE = 1;
-std::unordered_map<std::string, std::shared_ptr<RTLMask>> TinpMask::RTLMask::cache;
-std::unordered_map<std::string, std::shared_ptr<Mask>> TinpMask::Mask::MaskFactory::maskCache;
 void maybeThrow(int32_t status) {
     if (status != 0) {
         auto message = std::string("ArkUINode operation failed with status: ") + std::to_string(status);
@@ -25,65 +28,129 @@ void maybeThrow(int32_t status) {
     }
 }
 
+// 读取节点当前光标位置（UTF-8 字节）；有选区时取选区末端，读不到时视为在文本末尾
+static size_t readCaret(ArkUI_NodeHandle textNode, std::string_view content) {
+    auto api = NativeNodeApi::getInstance();
+    const ArkUI_AttributeItem *selection = api->getAttribute(textNode, NODE_TEXT_INPUT_TEXT_SELECTION);
+    if (selection != nullptr && selection->size >= 2 && selection->value[1].i32 >= 0) {
+        return byteOffsetOf(content, selection->value[1].i32);
+    }
+    const ArkUI_AttributeItem *caret = api->getAttribute(textNode, NODE_TEXT_INPUT_CARET_OFFSET);
+    if (caret != nullptr && caret->size >= 1 && caret->value[0].i32 >= 0) {
+        return byteOffsetOf(content, caret->value[0].i32);
+    }
+    return content.size();
+}
+
+// 把 content 放入节点的输入缓冲区并应用候选掩码；稳态下不分配内存
+static const Result &applyToNode(UserData *userData, std::string_view content, size_t caretPosition,
+                                 const std::shared_ptr<CaretString::CaretGravity> &caretGravity) {
+    CaretString &text = userData->input;
+    text.string.assign(content.data(), content.size());
+    text.caretPosition = static_cast<int>(caretPosition);
+    text.caretGravity = caretGravity;
+    // 各候选掩码与上一次输入比较，只重新扫描变化的部分
+    return userData->maskSet.apply(text, userData->binding->strategy);
+}
+
+/**
+ * Write `result` back to the node, touching only what differs from its current state.
+ *
+ * The text is written only if it changed, so an already formatted input does not trigger another
+ * `onChange`. The caret is moved to ``Result.formattedText.caretPosition`` when the text was written
+ * or the caret is elsewhere.
+ */
+static void writeToNode(UserData *userData, std::string_view content, size_t caretPosition, const Result &result) {
+    auto api = NativeNodeApi::getInstance();
+    const std::string &formatted = result.formattedText.string;
+    const size_t newCaret =
+        std::min(static_cast<size_t>(std::max(result.formattedText.caretPosition, 0)), formatted.size());
+    const bool textChanged = formatted != content;
+    if (textChanged) {
+        // 写入会同步或异步回调 onChange，先记下以便识别
+        userData->lastWritten.assign(formatted);
+        userData->lastInputLength = formatted.size();
+        ArkUI_AttributeItem item{.string = formatted.c_str()};
+        maybeThrow(api->setAttribute(userData->data, NODE_TEXT_INPUT_TEXT, &item));
+    }
+    if (textChanged || newCaret != caretPosition) {
+        ArkUI_NumberValue value[] = {{.i32 = utf16OffsetOf(formatted, newCaret)}};
+        ArkUI_AttributeItem item{value, 1};
+        maybeThrow(api->setAttribute(userData->data, NODE_TEXT_INPUT_CARET_POSITION, &item));
+    }
+}
+
+// setMask 注册的事件 targetId
+static constexpr int32_t ON_CHANGE_EVENT = 110;
+static constexpr int32_t ON_FOCUS_EVENT = 111;
+static constexpr int32_t ON_DISAPPEAR_EVENT = 112;
+
 void myEventReceiver(ArkUI_NodeEvent *event) {
+    int32_t eventId = OH_ArkUI_NodeEvent_GetTargetId(event);
+    // 节点上其他组件注册的事件也会送到这里，其 userData 不是本模块
+    if (eventId != ON_CHANGE_EVENT && eventId != ON_FOCUS_EVENT && eventId != ON_DISAPPEAR_EVENT) {
+        return;
+    }
     auto self = reinterpret_cast<RNTextInputMask *>(OH_ArkUI_NodeEvent_GetUserData(event));
     if (self == nullptr) {
         return;
     }
-    int32_t eventId = OH_ArkUI_NodeEvent_GetTargetId(event);
+    // 节点离开界面树：组件随后销毁时回收其绑定（列表单元复用时组件仍存活，绑定保留）
+    if (eventId == ON_DISAPPEAR_EVENT) {
+        self->scheduleBindingSweep();
+        return;
+    }
     ArkUI_NodeHandle textNode = OH_ArkUI_NodeEvent_GetNodeHandle(event);
-    void *data = NativeNodeApi::getInstance()->getUserData(textNode);
-    auto item = NativeNodeApi::getInstance()->getAttribute(textNode, NODE_TEXT_INPUT_TEXT);
-    std::string content = item->string;
-    UserData *userData = reinterpret_cast<UserData *>(data);
-    bool isDelete = userData->lastInputText.size() > content.size();
-    bool useAutocomplete = !isDelete ? userData->maskOptions.autocomplete.value() : false;
-    bool useAutoskip = isDelete ? userData->maskOptions.autoskip.value() : false;
+    UserData *userData = reinterpret_cast<UserData *>(NativeNodeApi::getInstance()->getUserData(textNode));
+    if (userData == nullptr) {
+        return;
+    }
+    // 文本由 ArkUI 持有，只在本次事件内读取
+    std::string_view content(NativeNodeApi::getInstance()->getAttribute(textNode, NODE_TEXT_INPUT_TEXT)->string);
+    const MaskBinding &binding = *userData->binding;
 
     // onChange 事件
-    if (eventId == 110) {
-        std::shared_ptr<CaretString::CaretGravity> caretGravity =
-            isDelete ? std::make_shared<CaretString::CaretGravity>(CaretString::Backward(useAutoskip))
-                     : std::make_shared<CaretString::CaretGravity>(CaretString::Forward(useAutocomplete));
-         CaretString text(content, content.length(), caretGravity);
-        auto maskObj = self->pickMask(text, userData->maskOptions, userData->primaryFormat);
-        auto result = maskObj->apply(text);
-        std::string resultString = result.formattedText.string;
-        DLOG(INFO) << "mask result complete: "<<result.complete;
-        userData->lastInputText = resultString;
-        std::string finalString = isDelete ? content : resultString;
-        ArkUI_AttributeItem item{.string = finalString.c_str()};
-        userData->lastInputText = finalString;
-        maybeThrow(NativeNodeApi::getInstance()->setAttribute(userData->data, NODE_TEXT_INPUT_TEXT, &item));
+    if (eventId == ON_CHANGE_EVENT) {
+        // 由上一次写回触发的 onChange：文本已是格式化结果
+        const bool echo = !userData->lastWritten.empty() && content == userData->lastWritten;
+        userData->lastWritten.clear();
+        if (echo) {
+            return;
+        }
+        // 新的编辑使后台尚未写回的结果作废
+        if (userData->formatter) {
+            userData->formatter->generation += 1;
+        }
+        bool isDelete = userData->lastInputLength > content.size();
+        userData->lastInputLength = content.size();
+        // 删除时保留用户编辑后的文本，无需 apply
+        if (isDelete) {
+            return;
+        }
+        const size_t caretPosition = readCaret(textNode, content);
+        const auto &caretGravity = forwardGravity(binding.autocomplete);
+        if (userData->formatter) {
+            self->formatAsync(userData, std::string(content), caretPosition, caretGravity);
+            return;
+        }
+        const Result &result = applyToNode(userData, content, caretPosition, caretGravity);
+        DLOG(INFO) << "mask result complete: " << result.complete;
+        writeToNode(userData, content, caretPosition, result);
     }
     // onFocus 事件
-    if (eventId == 111) {
-        if (userData->maskOptions.autocomplete.value()) {
-            std::string text = "";
-            text += content;
-            CaretString string(text, text.length(),
-                               std::make_shared<CaretString::Forward>(userData->maskOptions.autocomplete.value()));
-            auto maskObj = self->pickMask(string, userData->maskOptions, userData->primaryFormat);
-            std::string resultString = maskObj->apply(string).formattedText.string;
-            ArkUI_AttributeItem item{.string = resultString.c_str()};
-            maybeThrow(NativeNodeApi::getInstance()->setAttribute(userData->data, NODE_TEXT_INPUT_TEXT, &item));
+    if (eventId == ON_FOCUS_EVENT) {
+        if (binding.autocomplete) {
+            const size_t caretPosition = readCaret(textNode, content);
+            if (userData->formatter) {
+                userData->formatter->generation += 1;
+                self->formatAsync(userData, std::string(content), caretPosition, forwardGravity(true));
+                return;
+            }
+            const Result &result = applyToNode(userData, content, caretPosition, forwardGravity(true));
+            writeToNode(userData, content, caretPosition, result);
         }
     }
 }
-// 计算亲和度
-int calculateAffinity(Mask mask, const CaretString &text, std::string affinityCalculationStrategy) {
-    AffinityCalculationStrategy strategy;
-    if (affinityCalculationStrategy == "WHOLE_STRING") {
-        strategy = AffinityCalculationStrategy::WHOLE_STRING;
-    } else if (affinityCalculationStrategy == "PREFIX") {
-        strategy = AffinityCalculationStrategy::PREFIX;
-    } else if (affinityCalculationStrategy == "CAPACITY") {
-        strategy = AffinityCalculationStrategy::CAPACITY;
-    } else {
-        strategy = AffinityCalculationStrategy::EXTRACTED_VALUE_CAPACITY;
-    }
-    return AffinityCalculator::calculateAffinityOfMask(strategy, mask, text);
-}
 // 获取或创建 Mask
 std::shared_ptr<Mask> maskGetOrCreate(const std::string &format, const std::vector<Notation> &customNotations,
                                       bool rightToLeft) {
@@ -94,58 +161,113 @@ std::shared_ptr<Mask> maskGetOrCreate(const std::string &format, const std::vect
     }
 }
 
-std::shared_ptr<Mask> RNTextInputMask::pickMask(const CaretString &text, MaskOptions maskOptions,
-                                                std::string primaryMask) {
-    // 如果 affineFormats 为空，直接返回 primaryMask
-    if (maskOptions.affineFormats->size() <= 0)
-        return maskGetOrCreate(primaryMask, maskOptions.customNotations.value(), maskOptions.rightToLeft.value());
-    // 定义 MaskAffinity 结构体，用于存储 Mask 和相应的亲和度
-    struct MaskAffinity {
-        Mask mask;    // Mask 对象
-        int affinity; // 亲和度
-        MaskAffinity(const Mask &m, int a) : mask(m), affinity(a) {}
-    };
-
-    // 计算 primaryMask 的亲和度
-    int primaryAffinity = calculateAffinity(primaryMask, text, maskOptions.affinityCalculationStrategy.value());
+// 解析亲和度策略；未指定时使用默认的 WHOLE_STRING
+AffinityCalculationStrategy rnoh::affinityStrategyOf(const MaskOptions &maskOptions) {
+    const std::string strategy = maskOptions.affinityCalculationStrategy.value_or("WHOLE_STRING");
+    if (strategy == "WHOLE_STRING") {
+        return AffinityCalculationStrategy::WHOLE_STRING;
+    } else if (strategy == "PREFIX") {
+        return AffinityCalculationStrategy::PREFIX;
+    } else if (strategy == "CAPACITY") {
+        return AffinityCalculationStrategy::CAPACITY;
+    } else {
+        return AffinityCalculationStrategy::EXTRACTED_VALUE_CAPACITY;
+    }
+}
 
-    // 存储所有 mask 和亲和度的列表
-    std::vector<MaskAffinity> masksAndAffinities;
+// 按 primaryFormat、affineFormats 的顺序从缓存中取出候选掩码
+MaskSet rnoh::makeMaskSet(const MaskOptions &maskOptions, const std::string &primaryFormat) {
+    const auto &customNotations = maskOptions.customNotations.value();
+    bool rightToLeft = maskOptions.rightToLeft.value();
+    std::vector<std::shared_ptr<Mask>> masks;
+    masks.reserve(maskOptions.affineFormats->size() + 1);
+    masks.push_back(maskGetOrCreate(primaryFormat, customNotations, rightToLeft));
+    for (const std::string &format : *maskOptions.affineFormats) {
+        masks.push_back(maskGetOrCreate(format, customNotations, rightToLeft));
+    }
+    return MaskSet(std::move(masks));
+}
 
-    // 遍历 affineFormats 以获取每个格式的 Mask 和亲和度
-    for (const auto &format : *maskOptions.affineFormats) {
-        std::shared_ptr<Mask> mask =
-            maskGetOrCreate(format, maskOptions.customNotations.value(), maskOptions.rightToLeft.value());
-        int affinity = calculateAffinity(*mask, text, maskOptions.affinityCalculationStrategy.value());
-        masksAndAffinities.emplace_back(*mask, affinity);
+std::shared_ptr<const MaskBinding> MaskBinding::resolve(const std::string &primaryFormat,
+                                                       const MaskOptions &maskOptions) {
+    auto binding = std::make_shared<MaskBinding>();
+    const auto &customNotations = maskOptions.customNotations.value();
+    bool rightToLeft = maskOptions.rightToLeft.value();
+    binding->masks.reserve(maskOptions.affineFormats->size() + 1);
+    binding->masks.push_back(maskGetOrCreate(primaryFormat, customNotations, rightToLeft));
+    for (const std::string &format : *maskOptions.affineFormats) {
+        binding->masks.push_back(maskGetOrCreate(format, customNotations, rightToLeft));
     }
+    binding->strategy = affinityStrategyOf(maskOptions);
+    binding->autocomplete = maskOptions.autocomplete.value();
+    binding->asyncFormatting = maskOptions.asyncFormatting.value_or(false);
+    return binding;
+}
 
-    // 按亲和度降序排序
-    std::sort(masksAndAffinities.begin(), masksAndAffinities.end(),
-              [](const MaskAffinity &a, const MaskAffinity &b) { return a.affinity > b.affinity; });
+std::string MaskBinding::key(const std::string &primaryFormat, const MaskOptions &maskOptions) {
+    // 掩码部分与 MaskCache 的 key 相同，再依次追加 affine 格式（带长度前缀）与各开关
+    std::string key = MaskCache::key(primaryFormat, maskOptions.customNotations.value(), maskOptions.rightToLeft.value());
+    for (const std::string &format : *maskOptions.affineFormats) {
+        key += std::to_string(format.size());
+        key += ':';
+        key += format;
+    }
+    key += '/';
+    key += static_cast<char>('0' + static_cast<int>(affinityStrategyOf(maskOptions)));
+    key += maskOptions.autocomplete.value() ? 'C' : 'c';
+    key += maskOptions.asyncFormatting.value_or(false) ? 'A' : 'a';
+    return key;
+}
 
-    // 寻找插入位置
-    int insertIndex = -1;
-    for (size_t index = 0; index < masksAndAffinities.size(); ++index) {
-        if (primaryAffinity >= masksAndAffinities[index].affinity) {
-            insertIndex = static_cast<int>(index);
-            break;
+// 编译 formats 并放入缓存，跳过非法格式；返回可用掩码的数量。可在任意线程调用
+static size_t prewarm(const std::vector<std::string> &formats, const MaskOptions &maskOptions) {
+    size_t ready = 0;
+    for (const std::string &format : formats) {
+        try {
+            maskGetOrCreate(format, maskOptions.customNotations.value(), maskOptions.rightToLeft.value());
+            ready += 1;
+        } catch (const FormatError &) {
         }
     }
+    return ready;
+}
 
-    // 插入 primaryMask
-    if (insertIndex >= 0) {
-        masksAndAffinities.insert(masksAndAffinities.begin() + insertIndex, MaskAffinity(primaryMask, primaryAffinity));
-    } else {
-        masksAndAffinities.emplace_back(primaryMask, primaryAffinity);
-    }
+jsi::Value RNTextInputMask::prewarmMasks(jsi::Runtime &rt, std::vector<std::string> formats,
+                                         MaskOptions maskOptions) {
+    auto taskExecutor = m_ctx.taskExecutor;
+    auto jsInvoker = m_ctx.jsInvoker;
+    return createPromiseAsJSIValue(
+        rt, [taskExecutor, jsInvoker, formats = std::move(formats),
+             maskOptions = std::move(maskOptions)](jsi::Runtime &, std::shared_ptr<Promise> promise) {
+            taskExecutor->runTask(TaskThread::BACKGROUND, [jsInvoker, formats, maskOptions, promise]() mutable {
+                size_t ready = prewarm(formats, maskOptions);
+                // Promise 持有 JS 对象，只能在 JS 线程上 resolve 和释放
+                jsInvoker->invokeAsync([promise = std::move(promise), ready] {
+                    promise->resolve(jsi::Value(static_cast<double>(ready)));
+                });
+            });
+        });
+}
 
-    // 返回亲和度最高的 Mask
-    return std::make_shared<Mask>(masksAndAffinities.front().mask);
+std::shared_ptr<Mask> RNTextInputMask::pickMask(const CaretString &text, const MaskOptions &maskOptions,
+                                                const std::string &primaryMask) {
+    // 如果 affineFormats 为空，直接返回 primaryMask
+    if (maskOptions.affineFormats->size() <= 0)
+        return maskGetOrCreate(primaryMask, maskOptions.customNotations.value(), maskOptions.rightToLeft.value());
+    MaskSet maskSet = makeMaskSet(maskOptions, primaryMask);
+    maskSet.apply(text, affinityStrategyOf(maskOptions));
+    return maskSet.winnerMask();
 }
 
 void RNTextInputMask::setMask(int reactNode, std::string primaryFormat, MaskOptions maskOptions) {
-    auto task = [this, reactNode, primaryFormat, maskOptions] {
+    // 在后台预先编译全部候选格式，主线程解析绑定时直接命中缓存
+    std::vector<std::string> formats(1, primaryFormat);
+    formats.insert(formats.end(), maskOptions.affineFormats->begin(), maskOptions.affineFormats->end());
+    this->m_ctx.taskExecutor->runTask(TaskThread::BACKGROUND, [formats = std::move(formats), maskOptions] {
+        prewarm(formats, maskOptions);
+    });
+
+    auto task = [this, reactNode, primaryFormat = std::move(primaryFormat), maskOptions = std::move(maskOptions)] {
         auto weakInstance = m_ctx.instance;
         auto instance = weakInstance.lock();
         auto instanceCAPI = std::dynamic_pointer_cast<RNInstanceCAPI>(instance);
@@ -160,30 +282,197 @@ void RNTextInputMask::setMask(int reactNode, std::string primaryFormat, MaskOpti
         if(!input){
             throw std::runtime_error("find ComponentInstance failed,check the reactNode is Valid ");
         }
+        releaseDetachedBindings();
+        std::shared_ptr<const MaskBinding> binding;
+        try {
+            binding = internBinding(primaryFormat, maskOptions);
+        } catch (const FormatError &e) {
+            LOG(ERROR) << "setMask: invalid format: " << e.what();
+            return;
+        }
         ArkUINode &node = input->getLocalRootArkUINode();
         TextInputNode *textInputNode = dynamic_cast<TextInputNode *>(&node);
-        NativeNodeApi::getInstance()->registerNodeEvent(textInputNode->getArkUINodeHandle(),
-                                                        NODE_TEXT_INPUT_ON_CHANGE, 110, this);
-        NativeNodeApi::getInstance()->registerNodeEvent(textInputNode->getArkUINodeHandle(), NODE_ON_FOCUS, 111, this);
-
-        UserData *userData = new UserData({.data = textInputNode->getArkUINodeHandle(),
-                                           .maskOptions = maskOptions,
-                                           .primaryFormat = primaryFormat,
-                                           .node = reactNode});
-        this->m_userDatas.insert(userData);
-        NativeNodeApi::getInstance()->setUserData(textInputNode->getArkUINodeHandle(), userData);
-        NativeNodeApi::getInstance()->addNodeEventReceiver(textInputNode->getArkUINodeHandle(), myEventReceiver);
+        UserData *userData = acquireBinding(reactNode, textInputNode->getArkUINodeHandle());
+        // 重新绑定同一节点时原地更新选项；换掉 formatter 使旧选项下的后台结果不再写回
+        if (binding->asyncFormatting) {
+            userData->formatter = std::make_shared<AsyncFormatter>();
+            userData->formatter->maskSet = MaskSet(binding->masks);
+            userData->maskSet = MaskSet();
+        } else {
+            userData->formatter.reset();
+            userData->maskSet = MaskSet(binding->masks);
+        }
+        userData->binding = std::move(binding);
+        userData->owner = componentInstance;
+        userData->lastWritten.clear();
     };
     this->m_ctx.taskExecutor->runTask(TaskThread::MAIN, std::move(task));
 }
+
+void RNTextInputMask::unsetMask(int reactNode) {
+    this->m_ctx.taskExecutor->runTask(TaskThread::MAIN, [this, reactNode] {
+        auto found = m_bindingByTag.find(reactNode);
+        if (found != m_bindingByTag.end()) {
+            releaseBinding(found->second);
+        }
+    });
+}
+
+void RNTextInputMask::formatAsync(UserData *userData, std::string content, size_t caretPosition,
+                                  const std::shared_ptr<CaretString::CaretGravity> &caretGravity) {
+    std::shared_ptr<AsyncFormatter> formatter = userData->formatter;
+    std::shared_ptr<const MaskBinding> binding = userData->binding;
+    std::weak_ptr<ComponentInstance> owner = userData->owner;
+    ArkUI_NodeHandle handle = userData->data;
+    const uint64_t generation = formatter->generation.load();
+    auto taskExecutor = m_ctx.taskExecutor;
+    taskExecutor->runTask(TaskThread::BACKGROUND, [taskExecutor, formatter, binding, owner, handle, generation,
+                                                   content = std::move(content), caretPosition, caretGravity]() mutable {
+        std::unique_lock<std::mutex> lock(formatter->mutex);
+        // 排队期间用户又输入了，直接跳过
+        if (formatter->generation.load() != generation) {
+            return;
+        }
+        CaretString &text = formatter->input;
+        text.string = std::move(content);
+        text.caretPosition = static_cast<int>(caretPosition);
+        text.caretGravity = caretGravity;
+        Result result = formatter->maskSet.apply(text, binding->strategy);
+        lock.unlock();
+
+        taskExecutor->runTask(TaskThread::MAIN, [formatter, owner, handle, generation, result = std::move(result)] {
+            if (formatter->generation.load() != generation) {
+                return;
+            }
+            // 组件已销毁时节点句柄不再有效
+            auto alive = owner.lock();
+            if (!alive) {
+                return;
+            }
+            auto api = NativeNodeApi::getInstance();
+            auto *userData = reinterpret_cast<UserData *>(api->getUserData(handle));
+            if (userData == nullptr || userData->formatter != formatter) {
+                return;
+            }
+            std::string_view content(api->getAttribute(handle, NODE_TEXT_INPUT_TEXT)->string);
+            writeToNode(userData, content, readCaret(handle, content), result);
+        });
+    });
+}
+
+void RNTextInputMask::scheduleBindingSweep() {
+    // 在 disappear 回调之后执行，此时被删除的组件已经释放
+    this->m_ctx.taskExecutor->runTask(TaskThread::MAIN, [this] { releaseDetachedBindings(); });
+}
+
+void RNTextInputMask::releaseDetachedBindings() {
+    for (uint32_t slot = 0; slot < m_bindings.size(); ++slot) {
+        if (m_bindings[slot].data != nullptr && m_bindings[slot].owner.expired()) {
+            releaseBinding(slot);
+        }
+    }
+    for (auto it = m_sharedBindings.begin(); it != m_sharedBindings.end();) {
+        it = it->second.expired() ? m_sharedBindings.erase(it) : std::next(it);
+    }
+}
+
+std::shared_ptr<const MaskBinding> RNTextInputMask::internBinding(const std::string &primaryFormat,
+                                                                  const MaskOptions &maskOptions) {
+    std::weak_ptr<const MaskBinding> &shared = m_sharedBindings[MaskBinding::key(primaryFormat, maskOptions)];
+    std::shared_ptr<const MaskBinding> binding = shared.lock();
+    if (!binding) {
+        binding = MaskBinding::resolve(primaryFormat, maskOptions);
+        shared = binding;
+    }
+    return binding;
+}
+
+RNTextInputMask::~RNTextInputMask() {
+    // 节点可能比模块存活得久，不能留下指向槽位池的 userData 和接收器
+    for (uint32_t slot = 0; slot < m_bindings.size(); ++slot) {
+        if (m_bindings[slot].data != nullptr) {
+            releaseBinding(slot);
+        }
+    }
+    persistMaskCache();
+}
+
+bool RNTextInputMask::persistMaskCache() {
+    if (m_storePath.empty()) {
+        return false;
+    }
+    return ProgramStore::shared().write(m_storePath);
+}
+
+UserData *RNTextInputMask::acquireBinding(int reactNode, ArkUI_NodeHandle handle) {
+    auto api = NativeNodeApi::getInstance();
+    auto bound = m_bindingByHandle.find(handle);
+    uint32_t slot;
+    if (bound != m_bindingByHandle.end()) {
+        // 节点已绑定（可能是复用的列表单元换了 tag）：保留事件注册，只更新 tag 索引
+        slot = bound->second;
+        auto found = m_bindingByTag.find(m_bindings[slot].node);
+        if (found != m_bindingByTag.end() && found->second == slot) {
+            m_bindingByTag.erase(found);
+        }
+    } else {
+        if (m_freeBindings.empty()) {
+            slot = static_cast<uint32_t>(m_bindings.size());
+            m_bindings.emplace_back();
+        } else {
+            slot = m_freeBindings.back();
+            m_freeBindings.pop_back();
+        }
+        api->registerNodeEvent(handle, NODE_TEXT_INPUT_ON_CHANGE, ON_CHANGE_EVENT, this);
+        api->registerNodeEvent(handle, NODE_ON_FOCUS, ON_FOCUS_EVENT, this);
+        api->registerNodeEvent(handle, NODE_EVENT_ON_DISAPPEAR, ON_DISAPPEAR_EVENT, this);
+        api->setUserData(handle, &m_bindings[slot]);
+        api->addNodeEventReceiver(handle, myEventReceiver);
+        m_bindingByHandle[handle] = slot;
+    }
+    // 同一 tag 之前绑定在另一个节点上
+    auto previous = m_bindingByTag.find(reactNode);
+    if (previous != m_bindingByTag.end()) {
+        releaseBinding(previous->second);
+    }
+    UserData &userData = m_bindings[slot];
+    userData.data = handle;
+    userData.node = reactNode;
+    m_bindingByTag[reactNode] = slot;
+    return &userData;
+}
+
+void RNTextInputMask::releaseBinding(uint32_t slot) {
+    UserData &userData = m_bindings[slot];
+    // 组件已销毁时节点也已释放，不能再访问
+    if (!userData.owner.expired()) {
+        auto api = NativeNodeApi::getInstance();
+        // ON_CHANGE 与 ON_FOCUS 同时被 RNOH 的 TextInputNode 使用，只移除本模块的接收器
+        api->removeNodeEventReceiver(userData.data, myEventReceiver);
+        api->unregisterNodeEvent(userData.data, NODE_EVENT_ON_DISAPPEAR);
+        api->setUserData(userData.data, nullptr);
+    }
+    auto found = m_bindingByTag.find(userData.node);
+    if (found != m_bindingByTag.end() && found->second == slot) {
+        m_bindingByTag.erase(found);
+    }
+    auto bound = m_bindingByHandle.find(userData.data);
+    if (bound != m_bindingByHandle.end() && bound->second == slot) {
+        m_bindingByHandle.erase(bound);
+    }
+    // 换成新对象以释放候选掩码和缓冲区
+    userData = UserData();
+    m_freeBindings.push_back(slot);
+}
+
 static jsi::Value __hostFunction_RNTextInputMask_unmask(jsi::Runtime &rt, react::TurboModule &turboModule,
                                                         const jsi::Value *args, size_t count) {
     std::string maskValue = args[0].getString(rt).utf8(rt);
     std::string value = args[1].getString(rt).utf8(rt);
     bool autocomplete = args[2].getBool();
-    Mask maskObj(maskValue);
-    CaretString text(value, value.length(), std::make_shared<CaretString::Forward>(autocomplete));
-    auto r = maskObj.apply(text);
+    auto maskObj = Mask::MaskFactory::getOrCreate(maskValue, {});
+    CaretString text(value, value.length(), forwardGravity(autocomplete));
+    auto r = maskObj->apply(text);
     auto promise = rt.global().getPropertyAsFunction(rt, "Promise");
     return promise.callAsConstructor(
         rt, jsi::Function::createFromHostFunction(
@@ -202,15 +491,14 @@ static jsi::Value __hostFunction_RNTextInputMask_mask(jsi::Runtime &rt, react::T
     std::string maskValue = args[0].getString(rt).utf8(rt);
     std::string value = args[1].getString(rt).utf8(rt);
     bool autocomplete = args[2].getBool();
-    std::vector<Notation> emptyVector;
-    Mask maskObj(maskValue);
-    CaretString text(value, value.length(), std::make_shared<CaretString::Forward>(autocomplete));
-    auto r = maskObj.apply(text);
+    auto maskObj = Mask::MaskFactory::getOrCreate(maskValue, {});
+    CaretString text(value, value.length(), forwardGravity(autocomplete));
+    auto r = maskObj->apply(text);
     auto promise = rt.global().getPropertyAsFunction(rt, "Promise");
     return promise.callAsConstructor(
         rt, jsi::Function::createFromHostFunction(
                 rt, jsi::PropNameID::forAscii(rt, "mask"), 2,
-                [&r](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *args, size_t) -> jsi::Value {
+                [r](jsi::Runtime &runtime, const jsi::Value &thisValue, const jsi::Value *args, size_t) -> jsi::Value {
                     auto resolve = std::make_shared<jsi::Value>(runtime, args[0]);
                     auto reject = std::make_shared<jsi::Value>(runtime, args[1]);
                     resolve->asObject(runtime).asFunction(runtime).call(runtime, r.formattedText.string);
@@ -219,16 +507,90 @@ static jsi::Value __hostFunction_RNTextInputMask_mask(jsi::Runtime &rt, react::T
                 }));
 }
 
-static jsi::Value __hostFunction_RNTextInputMask_setMask(jsi::Runtime &rt, react::TurboModule &turboModule,
-                                                         const jsi::Value *args, size_t count) {
+const std::shared_ptr<CaretString::CaretGravity> &rnoh::forwardGravity(bool autocomplete) {
+    static const auto *withAutocomplete = new std::shared_ptr<CaretString::CaretGravity>(
+        std::make_shared<CaretString::Forward>(true));
+    static const auto *withoutAutocomplete = new std::shared_ptr<CaretString::CaretGravity>(
+        std::make_shared<CaretString::Forward>(false));
+    return autocomplete ? *withAutocomplete : *withoutAutocomplete;
+}
 
-    auto turbo = static_cast<RNTextInputMask *>(&turboModule);
-    if (turbo->grt == nullptr) {
-        turbo->grt = &rt;
+jsi::String rnoh::makeJSString(jsi::Runtime &rt, const std::string &value) {
+    bool ascii = std::all_of(value.begin(), value.end(),
+                             [](char character) { return (static_cast<unsigned char>(character) & 0x80) == 0; });
+    if (ascii) {
+        return jsi::String::createFromAscii(rt, value.data(), value.size());
     }
-    int reactNode = args[0].getNumber();
-    std::string primaryFormat = args[1].getString(rt).utf8(rt);
-    jsi::Object obj = args[2].asObject(rt);
+    return jsi::String::createFromUtf8(rt, reinterpret_cast<const uint8_t *>(value.data()), value.size());
+}
+
+// 解析 JS 传入的 Notation 数组
+static std::vector<Notation> readNotations(jsi::Runtime &rt, const jsi::Array &arrayCustomNotations) {
+    std::vector<Notation> customNotationsValues;
+    // 获取数组的长度
+    size_t length = arrayCustomNotations.size(rt);
+    // 遍历数组
+    for (size_t i = 0; i < length; ++i) {
+        // 获取数组元素
+        jsi::Object value = arrayCustomNotations.getValueAtIndex(rt, i).asObject(rt);
+        std::string character;
+        if (value.hasProperty(rt, "character")) {
+            character = value.getProperty(rt, "character").getString(rt).utf8(rt);
+        }
+        std::string characterSet;
+        if (value.hasProperty(rt, "characterSet")) {
+            characterSet = value.getProperty(rt, "characterSet").getString(rt).utf8(rt);
+        }
+        bool isOptional = false;
+        if (value.hasProperty(rt, "isOptional")) {
+            isOptional = value.getProperty(rt, "isOptional").getBool();
+        }
+        bool characterRanges = false;
+        if (value.hasProperty(rt, "characterRanges") && !value.getProperty(rt, "characterRanges").isUndefined()) {
+            characterRanges = value.getProperty(rt, "characterRanges").getBool();
+        }
+        customNotationsValues.emplace_back(character[0], characterSet, isOptional, characterRanges);
+    }
+    return customNotationsValues;
+}
+
+/**
+ * Shared implementation of ``maskSync`` and ``unmaskSync``.
+ *
+ * Uses the cached compiled mask and returns the string directly, without a Promise. The optional
+ * fourth argument holds the custom notations. A malformed format is reported as `null` instead of
+ * an exception crossing the JSI boundary.
+ */
+static jsi::Value applySync(jsi::Runtime &rt, const jsi::Value *args, size_t count, bool extract) {
+    std::string format = args[0].getString(rt).utf8(rt);
+    std::vector<Notation> customNotations;
+    if (count > 3 && args[3].isObject() && args[3].asObject(rt).isArray(rt)) {
+        customNotations = readNotations(rt, args[3].asObject(rt).asArray(rt));
+    }
+    std::shared_ptr<Mask> mask;
+    try {
+        mask = Mask::MaskFactory::getOrCreate(format, customNotations);
+    } catch (const FormatError &) {
+        return jsi::Value::null();
+    }
+    std::string value = args[1].getString(rt).utf8(rt);
+    CaretString text(value, value.length(), forwardGravity(args[2].getBool()));
+    Result result = mask->apply(text);
+    return makeJSString(rt, extract ? result.extractedValue : result.formattedText.string);
+}
+
+static jsi::Value __hostFunction_RNTextInputMask_maskSync(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                          const jsi::Value *args, size_t count) {
+    return applySync(rt, args, count, false);
+}
+
+static jsi::Value __hostFunction_RNTextInputMask_unmaskSync(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                            const jsi::Value *args, size_t count) {
+    return applySync(rt, args, count, true);
+}
+
+// 解析 JS 传入的 MaskOptions 对象
+static MaskOptions readMaskOptions(jsi::Runtime &rt, const jsi::Object &obj) {
     std::vector<std::string> affineFormatsValues; // 用于存储数组的值
     if (obj.hasProperty(rt, "affineFormats") && !obj.getProperty(rt, "affineFormats").isUndefined()) {
         jsi::Object affineFormats = obj.getProperty(rt, "affineFormats").asObject(rt);
@@ -241,12 +603,8 @@ static jsi::Value __hostFunction_RNTextInputMask_setMask(jsi::Runtime &rt, react
             for (size_t i = 0; i < length; ++i) {
                 // 获取数组元素
                 jsi::Value value = arrayAffineFormats.getValueAtIndex(rt, i);
-                std::cout << "===affineFormats index" + std::to_string(i) << "--" << value.getString(rt).utf8(rt)
-                          << std::endl;
                 affineFormatsValues.push_back(value.getString(rt).utf8(rt));
             }
-        } else {
-            std::cerr << "====The property 'myArray' is not an array." << std::endl;
         }
     }
     std::vector<Notation> customNotationsValues;
@@ -254,30 +612,7 @@ static jsi::Value __hostFunction_RNTextInputMask_setMask(jsi::Runtime &rt, react
         jsi::Object customNotations = obj.getProperty(rt, "customNotations").asObject(rt);
         // 确保它是一个数组
         if (customNotations.isArray(rt)) {
-            // 获取数组的长度
-            jsi::Array arrayCustomNotations = customNotations.asArray(rt);
-            size_t length = arrayCustomNotations.size(rt);
-            // 遍历数组
-            for (size_t i = 0; i < length; ++i) {
-                // 获取数组元素
-                jsi::Object value = arrayCustomNotations.getValueAtIndex(rt, i).asObject(rt);
-                std::string character;
-                if (value.hasProperty(rt, "character")) {
-                    character = value.getProperty(rt, "character").getString(rt).utf8(rt);
-                }
-                std::string characterSet;
-                if (value.hasProperty(rt, "character")) {
-                    characterSet = value.getProperty(rt, "characterSet").getString(rt).utf8(rt);
-                }
-                bool isOptional;
-                if (value.hasProperty(rt, "isOptional")) {
-                    isOptional = value.getProperty(rt, "isOptional").getBool();
-                }
-                Notation notation(character[0], characterSet, isOptional);
-                customNotationsValues.push_back(notation);
-            }
-        } else {
-            std::cerr << "====The property 'myArray' is not an array." << std::endl;
+            customNotationsValues = readNotations(rt, customNotations.asArray(rt));
         }
     }
 
@@ -303,18 +638,238 @@ static jsi::Value __hostFunction_RNTextInputMask_setMask(jsi::Runtime &rt, react
         rightToLeft = obj.getProperty(rt, "rightToLeft").asBool();
     }
 
-    auto maskOptions = new MaskOptions(affineFormatsValues, customNotationsValues, affinityCalculationStrategy,
-                                       autocomplete, autoskip, rightToLeft);
-    static_cast<RNTextInputMask *>(&turboModule)->setMask(reactNode, primaryFormat, *maskOptions);
+    bool asyncFormatting = false;
+    if (obj.hasProperty(rt, "asyncFormatting") && !obj.getProperty(rt, "asyncFormatting").isUndefined()) {
+        asyncFormatting = obj.getProperty(rt, "asyncFormatting").asBool();
+    }
+
+    return MaskOptions(affineFormatsValues, customNotationsValues, affinityCalculationStrategy, autocomplete, autoskip,
+                       rightToLeft, asyncFormatting);
+}
+
+// 打包 ArrayBuffer 布局：uint32 数量 n | uint32 偏移量[n + 1] | UTF-8 字节，偏移量相对字节区起点
+static constexpr size_t PACKED_WORD = sizeof(uint32_t);
+
+static uint32_t readPackedWord(const uint8_t *data, size_t index) {
+    uint32_t word;
+    std::memcpy(&word, data + index * PACKED_WORD, PACKED_WORD);
+    return word;
+}
+
+static void writePackedWord(std::string &buffer, size_t index, uint32_t word) {
+    std::memcpy(&buffer[index * PACKED_WORD], &word, PACKED_WORD);
+}
+
+/**
+ * Applies one compiled mask (or set of affine masks) to a batch of values.
+ *
+ * The masks are resolved once per batch, and every value goes through the same ``CaretString`` and
+ * ``MaskSet`` sessions, so consecutive values sharing a prefix are only rescanned past that prefix.
+ */
+class MaskBatch {
+public:
+    MaskBatch(const std::string &primaryFormat, const MaskOptions &maskOptions, bool extract)
+        : extract(extract), strategy(affinityStrategyOf(maskOptions)), maskSet(makeMaskSet(maskOptions, primaryFormat)),
+          text("", 0, forwardGravity(maskOptions.autocomplete.value())) {}
+
+    // 处理单个值；返回的引用在下一次调用前有效
+    const std::string &apply(const char *data, size_t length) {
+        text.string.assign(data, length);
+        text.caretPosition = static_cast<int>(length);
+        const Result &result = maskSet.apply(text, strategy);
+        return extract ? result.extractedValue : result.formattedText.string;
+    }
+
+    jsi::Array applyArray(jsi::Runtime &rt, const jsi::Array &values) {
+        size_t length = values.size(rt);
+        jsi::Array output(rt, length);
+        for (size_t i = 0; i < length; ++i) {
+            std::string value = values.getValueAtIndex(rt, i).getString(rt).utf8(rt);
+            const std::string &masked = apply(value.data(), value.size());
+            output.setValueAtIndex(
+                rt, i,
+                jsi::String::createFromUtf8(rt, reinterpret_cast<const uint8_t *>(masked.data()), masked.size()));
+        }
+        return output;
+    }
+
+    // 直接读取输入缓冲区，结果写入同样布局的新 ArrayBuffer
+    jsi::Value applyPacked(jsi::Runtime &rt, jsi::ArrayBuffer &values) {
+        const uint8_t *data = values.data(rt);
+        size_t size = values.size(rt);
+        if (size < PACKED_WORD) {
+            throw FormatError("packed values: buffer is too small");
+        }
+        size_t length = readPackedWord(data, 0);
+        size_t header = (length + 2) * PACKED_WORD;
+        if (header > size || readPackedWord(data, length + 1) != size - header) {
+            throw FormatError("packed values: header does not match buffer size");
+        }
+        const uint8_t *bytes = data + header;
+
+        std::string packed(header, '\0');
+        packed.reserve(size + header);
+        writePackedWord(packed, 0, static_cast<uint32_t>(length));
+        writePackedWord(packed, 1, 0);
+        for (size_t i = 0; i < length; ++i) {
+            uint32_t begin = readPackedWord(data, i + 1);
+            uint32_t end = readPackedWord(data, i + 2);
+            if (begin > end || end > size - header) {
+                throw FormatError("packed values: offsets are out of range");
+            }
+            packed += apply(reinterpret_cast<const char *>(bytes + begin), end - begin);
+            writePackedWord(packed, i + 2, static_cast<uint32_t>(packed.size() - header));
+        }
+
+        // 通过 JS 构造函数分配输出缓冲区，兼容不支持 MutableBuffer 的 JSI 版本
+        jsi::ArrayBuffer output = rt.global()
+                                      .getPropertyAsFunction(rt, "ArrayBuffer")
+                                      .callAsConstructor(rt, static_cast<double>(packed.size()))
+                                      .getObject(rt)
+                                      .getArrayBuffer(rt);
+        std::memcpy(output.data(rt), packed.data(), packed.size());
+        return jsi::Value(std::move(output));
+    }
+
+private:
+    bool extract;
+    AffinityCalculationStrategy strategy;
+    MaskSet maskSet;
+    CaretString text;
+};
+
+// maskBatch / unmaskBatch 的公共实现；格式错误或非法输入通过 Promise reject 返回
+static jsi::Value applyBatch(jsi::Runtime &rt, react::TurboModule &turboModule, const jsi::Value *args, size_t count,
+                             bool extract) {
+    jsi::Object promise = rt.global().getPropertyAsObject(rt, "Promise");
+    try {
+        std::string format = args[0].getString(rt).utf8(rt);
+        MaskOptions maskOptions = count > 2 && args[2].isObject() ? readMaskOptions(rt, args[2].asObject(rt))
+                                                                  : MaskOptions();
+        MaskBatch batch(format, maskOptions, extract);
+        jsi::Object values = args[1].asObject(rt);
+        jsi::Value output;
+        if (values.isArrayBuffer(rt)) {
+            jsi::ArrayBuffer buffer = values.getArrayBuffer(rt);
+            output = batch.applyPacked(rt, buffer);
+        } else {
+            output = jsi::Value(batch.applyArray(rt, values.asArray(rt)));
+        }
+        return promise.getPropertyAsFunction(rt, "resolve").callWithThis(rt, promise, output);
+    } catch (const std::exception &e) {
+        jsi::Value error = rt.global().getPropertyAsFunction(rt, "Error").callAsConstructor(
+            rt, jsi::String::createFromUtf8(rt, std::string(e.what())));
+        return promise.getPropertyAsFunction(rt, "reject").callWithThis(rt, promise, error);
+    }
+}
+
+static jsi::Value __hostFunction_RNTextInputMask_maskBatch(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                           const jsi::Value *args, size_t count) {
+    return applyBatch(rt, turboModule, args, count, false);
+}
+
+static jsi::Value __hostFunction_RNTextInputMask_unmaskBatch(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                             const jsi::Value *args, size_t count) {
+    return applyBatch(rt, turboModule, args, count, true);
+}
+
+// 编译一次掩码并返回 JS 句柄；格式非法时返回 null
+static jsi::Value __hostFunction_RNTextInputMask_compileMask(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                             const jsi::Value *args, size_t count) {
+    std::string format = args[0].getString(rt).utf8(rt);
+    MaskOptions maskOptions = count > 1 && args[1].isObject() ? readMaskOptions(rt, args[1].asObject(rt))
+                                                              : MaskOptions();
+    std::shared_ptr<Mask> mask;
+    try {
+        mask = maskGetOrCreate(format, maskOptions.customNotations.value(), maskOptions.rightToLeft.value());
+    } catch (const FormatError &) {
+        return jsi::Value::null();
+    }
+    auto handle = std::make_shared<MaskHostObject>(std::move(mask), maskOptions.autocomplete.value());
+    return jsi::Object::createFromHostObject(rt, std::move(handle));
+}
+
+// 内存紧张时释放已编译掩码缓存；可选参数为保留的字节数
+static jsi::Value __hostFunction_RNTextInputMask_trimMaskCache(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                               const jsi::Value *args, size_t count) {
+    size_t targetBytes = count > 0 && args[0].isNumber() ? static_cast<size_t>(args[0].getNumber()) : 0;
+    MaskCache::shared().trim(targetBytes);
+    return jsi::Value::undefined();
+}
+
+static jsi::Value __hostFunction_RNTextInputMask_maskCacheStats(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                                const jsi::Value *args, size_t count) {
+    MaskCache::Stats stats = MaskCache::shared().stats();
+    jsi::Object result(rt);
+    result.setProperty(rt, "hits", static_cast<double>(stats.hits));
+    result.setProperty(rt, "misses", static_cast<double>(stats.misses));
+    result.setProperty(rt, "evictions", static_cast<double>(stats.evictions));
+    result.setProperty(rt, "bytes", static_cast<double>(stats.bytes));
+    result.setProperty(rt, "entries", static_cast<double>(stats.entries));
+    return result;
+}
+
+static jsi::Value __hostFunction_RNTextInputMask_prewarmMasks(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                              const jsi::Value *args, size_t count) {
+    jsi::Array values = args[0].asObject(rt).asArray(rt);
+    std::vector<std::string> formats;
+    formats.reserve(values.size(rt));
+    for (size_t i = 0; i < values.size(rt); ++i) {
+        formats.push_back(values.getValueAtIndex(rt, i).getString(rt).utf8(rt));
+    }
+    MaskOptions maskOptions = count > 1 && args[1].isObject() ? readMaskOptions(rt, args[1].asObject(rt))
+                                                              : MaskOptions();
+    return static_cast<RNTextInputMask *>(&turboModule)->prewarmMasks(rt, std::move(formats), std::move(maskOptions));
+}
+
+// 把本次运行编译的掩码写入缓存文件，下次启动时直接映射使用
+static jsi::Value __hostFunction_RNTextInputMask_persistMaskCache(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                                  const jsi::Value *args, size_t count) {
+    return jsi::Value(static_cast<RNTextInputMask *>(&turboModule)->persistMaskCache());
+}
+
+static jsi::Value __hostFunction_RNTextInputMask_setMask(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                         const jsi::Value *args, size_t count) {
+
+    auto turbo = static_cast<RNTextInputMask *>(&turboModule);
+    if (turbo->grt == nullptr) {
+        turbo->grt = &rt;
+    }
+    int reactNode = args[0].getNumber();
+    std::string primaryFormat = args[1].getString(rt).utf8(rt);
+    MaskOptions maskOptions = readMaskOptions(rt, args[2].asObject(rt));
+    static_cast<RNTextInputMask *>(&turboModule)->setMask(reactNode, primaryFormat, maskOptions);
+    return jsi::Value::undefined();
+}
+
+static jsi::Value __hostFunction_RNTextInputMask_unsetMask(jsi::Runtime &rt, react::TurboModule &turboModule,
+                                                           const jsi::Value *args, size_t count) {
+    static_cast<RNTextInputMask *>(&turboModule)->unsetMask(args[0].getNumber());
     return jsi::Value::undefined();
 }
 
 RNTextInputMask::RNTextInputMask(const ArkTSTurboModule::Context ctx, const std::string name)
     : ArkTSTurboModule(ctx, name) {
+    // 缓存文件放在应用的 cacheDir 下；取不到目录时不读写缓存文件
+    folly::dynamic cacheDir = callSync("getCacheDir", {});
+    if (cacheDir.isString() && !cacheDir.getString().empty()) {
+        m_storePath = cacheDir.getString() + "/text_input_mask.programs";
+        ProgramStore::shared().open(m_storePath);
+    }
     // methodMap_ = {{"setMask", {3, setMask}}};
     methodMap_["setMask"] = MethodMetadata{3, __hostFunction_RNTextInputMask_setMask};
+    methodMap_["unsetMask"] = MethodMetadata{1, __hostFunction_RNTextInputMask_unsetMask};
     methodMap_["mask"] = MethodMetadata{3, __hostFunction_RNTextInputMask_mask};
     methodMap_["unmask"] = MethodMetadata{3, __hostFunction_RNTextInputMask_unmask};
+    methodMap_["maskSync"] = MethodMetadata{4, __hostFunction_RNTextInputMask_maskSync};
+    methodMap_["unmaskSync"] = MethodMetadata{4, __hostFunction_RNTextInputMask_unmaskSync};
+    methodMap_["compileMask"] = MethodMetadata{2, __hostFunction_RNTextInputMask_compileMask};
+    methodMap_["trimMaskCache"] = MethodMetadata{1, __hostFunction_RNTextInputMask_trimMaskCache};
+    methodMap_["maskCacheStats"] = MethodMetadata{0, __hostFunction_RNTextInputMask_maskCacheStats};
+    methodMap_["prewarmMasks"] = MethodMetadata{2, __hostFunction_RNTextInputMask_prewarmMasks};
+    methodMap_["persistMaskCache"] = MethodMetadata{0, __hostFunction_RNTextInputMask_persistMaskCache};
+    methodMap_["maskBatch"] = MethodMetadata{3, __hostFunction_RNTextInputMask_maskBatch};
+    methodMap_["unmaskBatch"] = MethodMetadata{3, __hostFunction_RNTextInputMask_unmaskBatch};
 }
 
 
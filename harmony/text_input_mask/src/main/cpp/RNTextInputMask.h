@@ -10,11 +10,18 @@
 #pragma once
 
 #include "RNOH/ArkTSTurboModule.h"
+#include "RNOH/ComponentInstance.h"
 #include "RNOH/arkui/NativeNodeApi.h"
 #include "RNOH/arkui/TextInputNode.h"
 #include "common/model/Notation.h"
 #include "common/RTLMask.h"
+#include "common/MaskSet.h"
 #include "common/model/AffinityCalculationStrategy.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 using namespace rnoh;
 using namespace facebook;
 using namespace TinpMask;
@@ -41,52 +48,125 @@ struct MaskOptions {
     std::optional<bool> autocomplete;                       // 可选布尔值
     std::optional<bool> autoskip;                           // 可选布尔值
     std::optional<bool> rightToLeft;                        // 可选布尔值
+    std::optional<bool> asyncFormatting;                    // 可选布尔值，在后台线程格式化输入
 
     MaskOptions()
         : affineFormats(std::vector<std::string>()), customNotations(std::vector<Notation>()),
-          affinityCalculationStrategy(std::nullopt), autocomplete(true), autoskip(false), rightToLeft(false) {}
+          affinityCalculationStrategy(std::nullopt), autocomplete(true), autoskip(false), rightToLeft(false),
+          asyncFormatting(false) {}
     MaskOptions(const std::vector<std::string> &formats, const std::vector<Notation> &notations,
-                const std::string &strategy, bool autoComp, bool autoSkip, bool rtl)
+                const std::string &strategy, bool autoComp, bool autoSkip, bool rtl, bool async = false)
         : affineFormats(formats), customNotations(notations),
           affinityCalculationStrategy(strategy.empty() ? std::nullopt : std::make_optional(strategy)),
-          autocomplete(autoComp), autoskip(autoSkip), rightToLeft(rtl) {}
+          autocomplete(autoComp), autoskip(autoSkip), rightToLeft(rtl), asyncFormatting(async) {}
 };
+/**
+ * Options of a ``setMask`` call resolved into everything the keystroke path needs.
+ *
+ * Built once per distinct option set and shared by every node bound with it; the compiled masks
+ * come from the mask cache, so the event handler never parses options, compares strategy names or
+ * looks formats up again. Immutable after creation.
+ */
+struct MaskBinding {
+    std::vector<std::shared_ptr<Mask>> masks; // 下标 0 为 primary，其后依次为 affine
+    AffinityCalculationStrategy strategy;
+    bool autocomplete;
+    bool asyncFormatting;
+
+    /**
+     * @throws FormatError if the primary format or an affine format is invalid.
+     */
+    static std::shared_ptr<const MaskBinding> resolve(const std::string &primaryFormat,
+                                                      const MaskOptions &maskOptions);
+    // 同一组选项得到相同的 key，用于在节点之间共享
+    static std::string key(const std::string &primaryFormat, const MaskOptions &maskOptions);
+};
+
+/**
+ * Per-node state of the asynchronous formatting mode (``MaskOptions.asyncFormatting``).
+ *
+ * Worker tasks run the affine selection and ``apply`` on ``maskSet`` under ``mutex``. The main
+ * thread bumps ``generation`` on every edit; a result is committed only if its generation is still
+ * current, so the last edit always wins.
+ */
+struct AsyncFormatter {
+    std::mutex mutex;
+    MaskSet maskSet;
+    CaretString input = CaretString("", 0, nullptr);
+    std::atomic<uint64_t> generation{0};
+};
+
 typedef struct {
     ArkUI_NodeHandle data;
-    MaskOptions maskOptions;
-    std::string primaryFormat;
+    std::shared_ptr<const MaskBinding> binding;
     int node;
-    std::string lastInputText = "";
+    std::weak_ptr<ComponentInstance> owner;          // 节点所属组件，销毁后绑定可回收
+    size_t lastInputLength = 0;                      // 上一次写回或读到的文本长度，用于识别删除
+    std::string lastWritten;                         // 上一次写回节点的文本，用于跳过由此回调的 onChange
+    CaretString input = CaretString("", 0, nullptr); // 每次事件复用的输入缓冲区
+    MaskSet maskSet; // binding 中候选掩码各自的增量状态
+    std::shared_ptr<AsyncFormatter> formatter; // 仅异步模式使用，取代 input 与 maskSet
 } UserData;
 
+AffinityCalculationStrategy affinityStrategyOf(const MaskOptions &maskOptions);
+MaskSet makeMaskSet(const MaskOptions &maskOptions, const std::string &primaryFormat);
+// 进程级共享的光标重力对象，避免每次调用都分配
+const std::shared_ptr<CaretString::CaretGravity> &forwardGravity(bool autocomplete);
+// 构造 JS 字符串：全部为 7 位 ASCII 时跳过 UTF-8 解码
+jsi::String makeJSString(jsi::Runtime &rt, const std::string &value);
+
 class JSI_EXPORT RNTextInputMask : public ArkTSTurboModule {
 public:
     RNTextInputMask(const ArkTSTurboModule::Context ctx, const std::string name);
     // reactNode: number, primaryFormat: string, options: TM.RNTextInputMask.MaskOptions
     void setMask(int reactNode, std::string primaryFormat, MaskOptions options);
+    // 解除 reactNode 上的掩码并回收其绑定；未绑定时忽略
+    void unsetMask(int reactNode);
+    // 回收所属组件已销毁的绑定，在主线程调用
+    void releaseDetachedBindings();
+    // 在主线程稍后执行 releaseDetachedBindings
+    void scheduleBindingSweep();
+    /**
+     * Format `content` on a background thread and write the result to the node on the main thread,
+     * unless the node was edited or rebound in the meantime. Asynchronous mode only.
+     */
+    void formatAsync(UserData *userData, std::string content, size_t caretPosition,
+                     const std::shared_ptr<CaretString::CaretGravity> &caretGravity);
+    // 在后台线程编译 formats 并放入缓存，返回在 JS 线程上以可用掩码数量 resolve 的 Promise
+    jsi::Value prewarmMasks(jsi::Runtime &rt, std::vector<std::string> formats, MaskOptions options);
+    // 把本次运行编译的掩码写入缓存文件；没有可用的 cacheDir 时返回 false
+    bool persistMaskCache();
     jsi::Value mask(std::string mask, std::string value, bool autocomplete);
     jsi::Value unmask(std::string mask, std::string value, bool autocomplete);
     jsi::Runtime *grt = nullptr;
-    std::shared_ptr<Mask> pickMask(const CaretString &text, MaskOptions maskOptions, std::string primaryMask);
+    std::shared_ptr<Mask> pickMask(const CaretString &text, const MaskOptions &maskOptions,
+                                   const std::string &primaryMask);
     
-//                 if (userData->maskOptions != nullptr) {
-//                     delete userData->maskOptions;
-//                     userData->maskOptions = nullptr;
-//                 }
-
-    // 释放资源
-    ~RNTextInputMask() {
-        for (auto userData : m_userDatas) {
-            if (userData != nullptr) {
-                delete userData;
-                userData = nullptr;
-            }
-        }
-    }
+    // 释放资源：解绑所有节点，再写出已编译的掩码
+    ~RNTextInputMask();
 
 
 private:
-    std::unordered_set<UserData *> m_userDatas;
+    /**
+     * Slot bound to the node `handle`, or a fresh one from the free list. The slot is registered
+     * under `reactNode`; an existing binding keeps its events and receiver. Main thread only.
+     */
+    UserData *acquireBinding(int reactNode, ArkUI_NodeHandle handle);
+    // 移除节点上的事件接收器并把槽位放回空闲列表
+    void releaseBinding(uint32_t slot);
+    // 取得与已绑定节点共享的 MaskBinding，没有时解析一个新的
+    std::shared_ptr<const MaskBinding> internBinding(const std::string &primaryFormat, const MaskOptions &maskOptions);
+
+    // 绑定记录的槽位池：deque 扩容时已有元素地址不变，可直接作为节点的 userData
+    std::deque<UserData> m_bindings;
+    std::vector<uint32_t> m_freeBindings;
+    std::unordered_map<int, uint32_t> m_bindingByTag;
+    // 节点句柄到槽位；节点的 userData 可能来自其他模块，是否已绑定只以此为准
+    std::unordered_map<ArkUI_NodeHandle, uint32_t> m_bindingByHandle;
+    // 按 MaskBinding::key 共享的已解析选项；节点全部解绑后条目过期，在 releaseDetachedBindings 中清理
+    std::unordered_map<std::string, std::weak_ptr<const MaskBinding>> m_sharedBindings;
+    // 已编译掩码的持久化缓存文件，位于应用的 cacheDir；为空时不持久化
+    std::string m_storePath;
 };
 
 
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "model/common.h"
+
+namespace TinpMask {
+
+/**
+ * Registers of the ``Mask::apply`` scan loop right before an input character is read.
+ */
+struct Checkpoint {
+    uint32_t state = 0;        // 当前指令下标
+    int affinity = 0;          // 累计亲和度
+    int caretShift = 0;        // 结果光标相对输入光标的偏移
+    uint32_t outputLength = 0; // 已生成的格式化文本长度
+    uint32_t valueLength = 0;  // 已提取的值长度
+    uint32_t stackDepth = 0;   // 自动完成栈深度
+};
+
+/**
+ * Keystroke-incremental apply state of a single text field.
+ *
+ * Remembers the input of the previous ``Mask::apply(text, session)`` call together with one
+ * ``Checkpoint`` per input position. The next call resumes scanning from the first position where
+ * the new input differs from the remembered one, so appending or deleting a character costs
+ * O(edit) instead of O(text length) while producing the same ``Result`` as a full ``Mask::apply``.
+ * A call with a different mask, gravity kind, autocomplete or autoskip flag starts over with a full
+ * scan.
+ */
+class ApplySession {
+    friend class Mask;
+
+private:
+    uint64_t maskIdentity = 0; // 检查点所属 Mask 的标识，0 表示尚未绑定
+    // 生成检查点时的光标重力；种类或开关变化时检查点作废
+    CaretString::CaretGravity::Kind gravity = CaretString::CaretGravity::Kind::Custom;
+    bool autocomplete = false;
+    bool autoskip = false;
+    int caretPosition = 0;     // 上一次输入的光标位置
+    std::string input;         // 上一次的输入文本
+    std::string output;        // 主扫描生成的格式化文本
+    std::string value;         // 主扫描提取的值
+    std::unique_ptr<AutocompletionStack> autocompletionStack;
+    std::vector<Checkpoint> checkpoints; // checkpoints[i] 为读取 input[i] 之前的寄存器
+    Result result;
+
+public:
+    ApplySession() : result(CaretString("", 0, nullptr), "", 0, false, "") {}
+
+    // 丢弃所有检查点，下一次调用执行完整扫描
+    void reset() {
+        maskIdentity = 0;
+        checkpoints.clear();
+    }
+
+    // 上一次调用的结果
+    const Result &lastResult() const { return result; }
+};
+
+} // namespace TinpMask
@@ -1,11 +1,12 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
-#include <string>
-#include <memory>
 #include "model/common.h"
 #include "model/Notation.h"
 #include "model/State.h"
+#include "model/StateArena.h"
+#include "model/Program.h"
 #include "FormatError.h"
 #include "FormatSanitizer.h"
 
@@ -18,107 +19,123 @@ private:
 public:
     Compiler(const std::vector<Notation> &notations) : customNotations(notations) {}
 
-    std::shared_ptr<State> compile(const std::string &formatString) {
+    /**
+     * Compile a format into a chain of states allocated in `arena`.
+     *
+     * @returns the initial state; it stays valid as long as `arena` (or the arena it is moved into).
+     */
+    State *compile(const std::string &formatString, StateArena &arena) {
         FormatSanitizer sanitizer;
         std::string sanitizedString = sanitizer.sanitize(formatString);
-        return compile(sanitizedString, false, false, '\0');
+        return compile(sanitizedString, false, false, '\0', arena);
     }
 
-    std::shared_ptr<State> compile(const std::string &formatString, bool valuable, bool fixed, char lastCharacter) {
-        if (formatString.empty()) {
-            return std::make_shared<EOLState>();
-        }
-
-        char ch = formatString.front();
-        switch (ch) {
-        case '[':
-            if (lastCharacter != '\\') {
-                return compile(formatString.substr(1), true, false, ch);
-            }
-            break;
-
-        case '{':
-            if (lastCharacter != '\\') {
-                return compile(formatString.substr(1), false, true, ch);
-            }
-            break;
-
-        case ']':
-        case '}':
-            if (lastCharacter != '\\') {
-                return compile(formatString.substr(1), false, false, ch);
-            }
-            break;
-
-        case '\\':
-            if (lastCharacter != '\\') {
-                return compile(formatString.substr(1), valuable, fixed, ch);
-            }
-            break;
+    /**
+     * Compile a sanitized format into a chain of states.
+     *
+     * The format is read once by ``scanFormat`` and the chain is then linked back to front, so
+     * compilation is linear in the format length and does not recurse. Every state and custom type
+     * descriptor is placed in `arena`, which reserves room for all of them up front.
+     */
+    State *compile(std::string_view formatString, bool valuable, bool fixed, char lastCharacter, StateArena &arena) {
+        std::vector<Token> tokens;
+        tokens.reserve(formatString.length());
+        const bool elliptical =
+            scanFormat(formatString, valuable, fixed, lastCharacter, [this, &tokens](TokenKind kind, char ch) {
+                tokens.push_back(kind == TokenKind::Custom ? customToken(ch) : Token{kind, ch, nullptr});
+            });
+        arena.reserve(arenaCapacity(tokens, elliptical));
 
-        default:
-            break;
+        State *tail;
+        if (elliptical) {
+            const ValueState::ValueStateType *inheritedType = determineInheritedType(lastCharacter, arena);
+            tail = arena.make<ValueState>(nullptr, arena.make<ValueState::Ellipsis>(inheritedType));
+        } else {
+            tail = arena.make<EOLState>();
         }
+        for (auto token = tokens.rbegin(); token != tokens.rend(); ++token) {
+            tail = makeState(*token, tail, arena);
+        }
+        return tail;
+    }
 
-        if (valuable) {
-            switch (ch) {
-            case '0':
-                return std::make_shared<ValueState>(
-                    this->compile(formatString.substr(1), true, false, ch),
-                    // std::static_pointer_cast<ValueState::StateType>( std::make_shared<ValueState::Numeric>())
-                    std::make_shared<ValueState::Numeric>());
-
-            case 'A':
-                return std::make_shared<ValueState>(this->compile(formatString.substr(1), true, false, ch),
-                                                    std::make_shared<ValueState::Literal>());
-
-            case '_':
-                return std::make_shared<ValueState>(this->compile(formatString.substr(1), true, false, ch),
-                                                    std::make_shared<ValueState::AlphaNumeric>());
-
-            case '...':
-                return std::make_unique<ValueState>(determineInheritedType(lastCharacter));
-
-            case '9':
-                return std::make_shared<OptionalValueState>(this->compile(formatString.substr(1), true, false, ch),
-                                                            std::make_shared<OptionalValueState::Numeric>()
-
-                );
-
-            case 'a':
-                return std::make_shared<OptionalValueState>(this->compile(formatString.substr(1), true, false, ch),
-                                                            std::make_shared<OptionalValueState::Literal>());
-
-            case '-':
-                return std::make_shared<OptionalValueState>(this->compile(formatString.substr(1), true, false, ch),
-                                                            std::make_shared<OptionalValueState::AlphaNumeric>());
+    // 格式字符对应的状态类型；Custom 为尚未按自定义记号解析的 [] 内字符
+    enum class TokenKind : uint8_t { Fixed, Free, Value, OptionalValue, Custom };
 
-            default:
-                return compileWithCustomNotations(ch, formatString);
+    /**
+     * Walk a sanitized format and report every character that becomes a state.
+     *
+     * Tracks the current block (`valuable` for `[]`, `fixed` for `{}`) and the previous character,
+     * which decides whether brackets are escaped and which type an ellipsis inherits. Calls
+     * `onToken(kind, character)` in format order. Scanning stops at the first ellipsis inside a
+     * `[]` block, since nothing after it is compiled.
+     *
+     * Shared by runtime compilation and ``StaticProgram``, hence `constexpr`.
+     *
+     * @returns `true` if the format ends with an ellipsis; `lastCharacter` then holds the
+     * character whose type the ellipsis inherits.
+     */
+    template <typename OnToken>
+    static constexpr bool scanFormat(std::string_view formatString, bool valuable, bool fixed, char &lastCharacter,
+                                     OnToken &&onToken) {
+        for (size_t index = 0; index < formatString.length(); ++index) {
+            const char ch = formatString[index];
+            if (lastCharacter != '\\') {
+                bool control = true;
+                switch (ch) {
+                case '[':
+                    valuable = true;
+                    fixed = false;
+                    break;
+                case '{':
+                    valuable = false;
+                    fixed = true;
+                    break;
+                case ']':
+                case '}':
+                    valuable = false;
+                    fixed = false;
+                    break;
+                case '\\':
+                    break;
+                default:
+                    control = false;
+                    break;
+                }
+                if (control) {
+                    lastCharacter = ch;
+                    continue;
+                }
             }
-        }
-        if (fixed) {
-            return std::make_shared<FixedState>(compile(formatString.substr(1), false, true, ch), ch);
-        }
-        return std::make_shared<FreeState>(compile(formatString.substr(1), false, false, ch), ch);
-    }
 
-    std::unique_ptr<State> compileWithCustomNotations(char c, const std::string &str) {
-        for (const auto &customNotation : customNotations) {
-            if (customNotation.character == c) {
-                std::shared_ptr<State> compiledState = compile(str.substr(1), true, false, c);
-                if (customNotation.isOptional) {
-                    return std::make_unique<OptionalValueState>(std::move(compiledState),
-                                                                std::make_shared<OptionalValueState::Custom>(c, customNotation.characterSet));
-                } else {
-                    return std::make_unique<ValueState>(std::move(compiledState),
-                                                        std::make_shared<ValueState::Custom>(c, customNotation.characterSet));
+            if (valuable) {
+                if (formatString.compare(index, EllipsisSymbolLength, EllipsisSymbol) == 0) {
+                    return true;
+                }
+                switch (ch) {
+                case '0':
+                case 'A':
+                case '_':
+                    onToken(TokenKind::Value, ch);
+                    break;
+                case '9':
+                case 'a':
+                case '-':
+                    onToken(TokenKind::OptionalValue, ch);
+                    break;
+                default:
+                    onToken(TokenKind::Custom, ch);
+                    break;
                 }
+            } else {
+                onToken(fixed ? TokenKind::Fixed : TokenKind::Free, ch);
             }
+            lastCharacter = ch;
         }
-        throw FormatError();
+        return false;
     }
-     std::shared_ptr<ValueState::ValueStateType> determineInheritedType(std::optional<char> lastCharacter) {
+
+    const ValueState::ValueStateType *determineInheritedType(std::optional<char> lastCharacter, StateArena &arena) {
         if (!lastCharacter.has_value()) {
             throw FormatError(); // 处理空字符情况，抛出异常
         }
@@ -127,24 +144,24 @@ public:
         switch (character) {
             case '0':
             case '9':
-                return std::make_shared<ValueState::Numeric>();
+                return &numericValueType;
 
             case 'A':
             case 'a':
-                return std::make_shared<ValueState::Literal>();
+                return &literalValueType;
 
             case '_':
             case '-':
-            case '...':
             case '[':
-                return  std::make_shared<ValueState::AlphaNumeric>();
+                return &alphaNumericValueType;
 
             default:
-                return determineTypeWithCustomNotations(lastCharacter);
+                return determineTypeWithCustomNotations(lastCharacter, arena);
         }
     }
 
-     std::shared_ptr<ValueState::ValueStateType> determineTypeWithCustomNotations(std::optional<char> lastCharacter) {
+    const ValueState::ValueStateType *determineTypeWithCustomNotations(std::optional<char> lastCharacter,
+                                                                       StateArena &arena) {
         if (!lastCharacter.has_value()) {
             throw FormatError(); // 处理空字符情况，抛出异常
         }
@@ -152,11 +169,188 @@ public:
         for (const auto &customNotation : customNotations) {
             if (customNotation.character == character) {
                 // 返回 Custom 状态
-                return  std::make_shared<ValueState::Custom>(lastCharacter.value(),customNotation.characterSet); // 可以根据需要调整返回内容
+                return arena.make<ValueState::Custom>(lastCharacter.value(), internCharacterClass(customNotation));
             }
         }
 
         throw FormatError(); // 未找到匹配项，抛出异常
     }
+
+    /**
+     * Flatten a compiled ``State`` chain into a ``Program``.
+     *
+     * Every state becomes one ``Instruction``; value state types are resolved into entries of the
+     * program character class table once, so that ``Mask::apply`` never needs RTTI.
+     */
+    Program assemble(const State *initialState) const {
+        Program program;
+        for (const State *state = initialState; state != nullptr; state = state->child) {
+            if (auto fixedState = dynamic_cast<const FixedState *>(state)) {
+                program.instructions.push_back({InstructionKind::Fixed, fixedState->ownCharacter, 0, 0});
+                program.autocompletableCount += 1;
+            } else if (auto freeState = dynamic_cast<const FreeState *>(state)) {
+                program.instructions.push_back({InstructionKind::Free, freeState->ownCharacter, 0, 0});
+                program.autocompletableCount += 1;
+            } else if (auto valueState = dynamic_cast<const ValueState *>(state)) {
+                uint8_t flags = 0;
+                const ValueState::ValueStateType *type = valueState->type;
+                if (auto ellipsis = dynamic_cast<const ValueState::Ellipsis *>(type)) {
+                    flags |= Instruction::Elliptical;
+                    type = ellipsis->inheritedType;
+                }
+                char placeholder = '\0';
+                if (auto custom = dynamic_cast<const ValueState::Custom *>(type)) {
+                    placeholder = custom->character;
+                } else {
+                    placeholder = placeholderOf(type->getName());
+                }
+                program.instructions.push_back({InstructionKind::Value, placeholder,
+                                                characterClassOf(program, *valueState->characterClass), flags});
+            } else if (auto optionalValueState = dynamic_cast<const OptionalValueState *>(state)) {
+                char placeholder = '\0';
+                if (auto custom = dynamic_cast<const OptionalValueState::Custom *>(optionalValueState->type)) {
+                    placeholder = custom->character;
+                } else {
+                    placeholder = placeholderOf(optionalValueState->type->getName());
+                }
+                program.instructions.push_back({InstructionKind::OptionalValue, placeholder,
+                                                characterClassOf(program, *optionalValueState->characterClass), 0});
+            } else {
+                break; // EOLState
+            }
+        }
+        program.instructions.push_back({InstructionKind::EOL, '\0', 0, 0});
+        program.indexSuffixes();
+        return program;
+    }
+
+private:
+    // 编译过程中单个格式字符对应的状态描述
+    struct Token {
+        TokenKind kind;
+        char character;
+        const Notation *customNotation; // 自定义记号；内置类型为 nullptr
+    };
+
+    Token customToken(char character) const {
+        for (const auto &customNotation : customNotations) {
+            if (customNotation.character == character) {
+                return {customNotation.isOptional ? TokenKind::OptionalValue : TokenKind::Value, character,
+                        &customNotation};
+            }
+        }
+        throw FormatError();
+    }
+
+    // 内置值类型无状态，所有图共享
+    static inline const ValueState::Numeric numericValueType{};
+    static inline const ValueState::Literal literalValueType{};
+    static inline const ValueState::AlphaNumeric alphaNumericValueType{};
+    static inline const OptionalValueState::Numeric numericOptionalValueType{};
+    static inline const OptionalValueState::Literal literalOptionalValueType{};
+    static inline const OptionalValueState::AlphaNumeric alphaNumericOptionalValueType{};
+
+    // 状态图所需的字节数：每个记号一个状态，自定义记号另加一个类型，末尾为 EOL 或省略号状态
+    static size_t arenaCapacity(const std::vector<Token> &tokens, bool elliptical) {
+        size_t bytes = elliptical ? sizeof(ValueState) + sizeof(ValueState::Ellipsis) + sizeof(ValueState::Custom)
+                                  : sizeof(EOLState);
+        for (const Token &token : tokens) {
+            switch (token.kind) {
+            case TokenKind::Fixed:
+                bytes += sizeof(FixedState);
+                break;
+            case TokenKind::Free:
+                bytes += sizeof(FreeState);
+                break;
+            case TokenKind::Value:
+                bytes += sizeof(ValueState) + (token.customNotation != nullptr ? sizeof(ValueState::Custom) : 0);
+                break;
+            case TokenKind::OptionalValue:
+                bytes += sizeof(OptionalValueState) +
+                         (token.customNotation != nullptr ? sizeof(OptionalValueState::Custom) : 0);
+                break;
+            case TokenKind::Custom:
+                break;
+            }
+        }
+        return bytes;
+    }
+
+    static State *makeState(const Token &token, State *child, StateArena &arena) {
+        switch (token.kind) {
+        case TokenKind::Fixed:
+            return arena.make<FixedState>(child, token.character);
+        case TokenKind::Free:
+            return arena.make<FreeState>(child, token.character);
+        case TokenKind::Value:
+            return arena.make<ValueState>(child, valueTypeOf(token, arena));
+        case TokenKind::OptionalValue:
+            return arena.make<OptionalValueState>(child, optionalValueTypeOf(token, arena));
+        case TokenKind::Custom:
+            break;
+        }
+        return child;
+    }
+
+    static const ValueState::ValueStateType *valueTypeOf(const Token &token, StateArena &arena) {
+        if (token.customNotation != nullptr) {
+            return arena.make<ValueState::Custom>(token.character, internCharacterClass(*token.customNotation));
+        }
+        switch (token.character) {
+        case '0':
+            return &numericValueType;
+        case 'A':
+            return &literalValueType;
+        default:
+            return &alphaNumericValueType;
+        }
+    }
+
+    static const OptionalValueState::OptionalValueStateType *optionalValueTypeOf(const Token &token,
+                                                                                StateArena &arena) {
+        if (token.customNotation != nullptr) {
+            return arena.make<OptionalValueState::Custom>(token.character,
+                                                          internCharacterClass(*token.customNotation));
+        }
+        switch (token.character) {
+        case '9':
+            return &numericOptionalValueType;
+        case 'a':
+            return &literalOptionalValueType;
+        default:
+            return &alphaNumericOptionalValueType;
+        }
+    }
+
+    static const CharacterClass *internCharacterClass(const Notation &notation) {
+        return CharacterClass::intern(notation.characterClass());
+    }
+
+    static char placeholderOf(StateTypeName type) {
+        switch (type) {
+        case StateTypeName::Numeric:
+            return '0';
+        case StateTypeName::Literal:
+            return 'a';
+        case StateTypeName::AlphaNumeric:
+            return '-';
+        default:
+            return '\0';
+        }
+    }
+
+    // 在程序的字符类表中查找或追加位图，相同位图只保存一份
+    static uint8_t characterClassOf(Program &program, const CharacterClass &characterClass) {
+        for (size_t i = 0; i < program.characterClasses.size(); ++i) {
+            if (program.characterClasses[i] == characterClass) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        if (program.characterClasses.size() > UINT8_MAX) {
+            throw FormatError("Too many character classes");
+        }
+        program.characterClasses.push_back(characterClass);
+        return static_cast<uint8_t>(program.characterClasses.size() - 1);
+    }
 };
 } // namespace TinpMask
\ No newline at end of file
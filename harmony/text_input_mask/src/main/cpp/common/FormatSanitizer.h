@@ -1,225 +1,318 @@
 #pragma once
-#include <iostream>
-#include <vector>
-#include <string>
 #include <algorithm>
-#include "Compiler.h"
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "FormatError.h"
+#include "model/common.h"
 
 namespace TinpMask {
 
-
-class Compiler;
+/**
+ * Brings a format string into the canonical form expected by ``Compiler``.
+ *
+ * Validates brackets, splits `[]` blocks that mix digits, letters and alphanumerics (`[00AA]`
+ * becomes `[00][AA]`) and sorts the characters inside every `[]` block so that mandatory symbols
+ * come before optional ones. Everything outside `[]` blocks is copied unchanged.
+ *
+ * All of this happens in a single scan that writes straight into the output buffer: each `[]`
+ * block is split and sorted in place as soon as it is closed.
+ */
 class FormatSanitizer {
 public:
     std::string sanitize(const std::string &formatString) {
-        checkOpenBraces(formatString);
-        std::vector<std::string> blocks = divideBlocksWithMixedCharacters(getFormatBlocks(formatString));
-        return sortFormatBlocks(blocks);
+        std::string sanitizedString;
+        sanitize(formatString, sanitizedString);
+        return sanitizedString;
     }
 
-    std::vector<std::string> getFormatBlocks(const std::string &formatString) {
-        std::vector<std::string> blocks;
-        std::string currentBlock;
-        bool escape = false;
+    /**
+     * Sanitize `formatString` into `output`, replacing its contents.
+     *
+     * @throws FormatError if a `[` or `{` block is opened while the previous one is still open.
+     */
+    void sanitize(std::string_view formatString, std::string &output) {
+        output.clear();
+        output.reserve(formatString.length() + 2);
+        sanitizeInto(formatString, output);
+    }
 
-        for (char ch : formatString) {
-            if (ch == '\\') {
-                if (!escape) {
-                    escape = true;
-                    currentBlock += ch;
-                    continue;
-                }
-            }
+    /**
+     * Sanitize `formatString`, appending to an initially empty `output`.
+     *
+     * `Output` needs `size`, `push_back`, `resize` (to shrink) and `operator[]`. The scan itself
+     * is `constexpr`, so with a fixed-capacity buffer it runs during compilation (see
+     * ``StaticProgram``).
+     */
+    template <typename Output>
+    static constexpr void sanitizeInto(std::string_view formatString, Output &output) {
+        BraceCheck braces;
+        bool escape = false;   // 上一个字符是否为转义用的反斜杠
+        bool inBlock = false;  // 是否位于 [] 块内
+        size_t blockStart = 0; // 当前子块 '[' 在 output 中的位置
+        uint8_t present = 0;   // 当前子块中出现过的 0 9 A a - _
+        char last = '\0';      // 当前子块最后写入的字符
 
-            if ((ch == '[' || ch == '{') && !escape) {
-                if (!currentBlock.empty()) {
-                    blocks.push_back(currentBlock);
-                }
-                currentBlock.clear();
-            }
-
-            currentBlock += ch;
+        for (char ch : formatString) {
+            braces.check(ch);
 
-            if ((ch == ']' || ch == '}') && !escape) {
-                blocks.push_back(currentBlock);
-                currentBlock.clear();
+            if (ch == '\\' && !escape) {
+                escape = true;
+                output.push_back(ch);
+                last = ch;
+                continue;
             }
-
+            const bool opens = (ch == '[' || ch == '{') && !escape;
+            const bool closes = (ch == ']' || ch == '}') && !escape;
             escape = false;
-        }
-
-        if (!currentBlock.empty()) {
-            blocks.push_back(currentBlock);
-        }
-
-        return blocks;
-    }
-
 
-public:
-    std::vector<std::string> divideBlocksWithMixedCharacters(const std::vector<std::string> &blocks) {
-        std::vector<std::string> resultingBlocks;
-
-        for (const auto &block : blocks) {
-            if (!block.empty() && block.substr(0, 1) == "[") { // 使用 substr 来检查开头
-                std::string blockBuffer;
-                for (char blockCharacter : block) {
-                    if (blockCharacter == '[') {
-                        blockBuffer += blockCharacter;
-                        continue;
-                    }
-
-                    if (blockCharacter == ']' && !endsWithEscapeCharacter(blockBuffer)) {
-                        blockBuffer += blockCharacter;
-                        resultingBlocks.push_back(blockBuffer);
-                        break;
-                    }
-
-                    if (isDigit(blockCharacter)) {
-                        if (containsAny(blockBuffer, {'A', 'a', '-', '_'})) {
-                            blockBuffer += "]";
-                            resultingBlocks.push_back(blockBuffer);
-                            blockBuffer = "[" + std::string(1, blockCharacter);
-                            continue;
-                        }
-                    }
-
-                    if (isAlpha(blockCharacter)) {
-                        if (containsAny(blockBuffer, {'0', '9', '-', '_'})) {
-                            blockBuffer += "]";
-                            resultingBlocks.push_back(blockBuffer);
-                            blockBuffer = "[" + std::string(1, blockCharacter);
-                            continue;
-                        }
-                    }
-
-                    if (isSpecialCharacter(blockCharacter)) {
-                        if (containsAny(blockBuffer, {'0', '9', 'A', 'a'})) {
-                            blockBuffer += "]";
-                            resultingBlocks.push_back(blockBuffer);
-                            blockBuffer = "[" + std::string(1, blockCharacter);
-                            continue;
-                        }
-                    }
-
-                    blockBuffer += blockCharacter;
+            if (opens) {
+                // 未闭合的 [] 子块被丢弃
+                if (inBlock) {
+                    output.resize(blockStart);
+                }
+                inBlock = ch == '[';
+                if (inBlock) {
+                    blockStart = output.size();
+                    present = 0;
                 }
-            } else {
-                resultingBlocks.push_back(block);
+                output.push_back(ch);
+                last = ch;
+                continue;
             }
-        }
-
-        return resultingBlocks;
-    }
-
-private:
-    bool endsWithEscapeCharacter(const std::string &str) const { return !str.empty() && str.back() == '\\'; }
-
-    bool isDigit(char ch) const { return ch >= '0' && ch <= '9'; }
-
-    bool isAlpha(char ch) const { return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z'); }
-
-    bool isSpecialCharacter(char ch) const { return ch == '-' || ch == '_'; }
-
-    bool containsAny(const std::string &str, const std::vector<char> &characters) const {
-        for (char c : characters) {
-            if (str.find(c) != std::string::npos) {
-                return true;
+            if (!inBlock) {
+                output.push_back(ch);
+                continue;
             }
-        }
-        return false;
-    }
 
-public:
-    std::string sortFormatBlocks(const std::vector<std::string> &blocks) {
-        std::vector<std::string> sortedBlocks;
-
-        for (const auto &block : blocks) {
-            std::string sortedBlock;
-
-            if (startsWith(block, "[")) {
-                std::string cleanedBlock = block.substr(1, block.size() - 2); // Remove the surrounding brackets
-                if (cleanedBlock.find("0") != std::string::npos || cleanedBlock.find("9") != std::string::npos ||
-                    cleanedBlock.find("a") != std::string::npos || cleanedBlock.find("A") != std::string::npos) {
-                    sortedBlock = "[" + sortString(cleanedBlock) + "]";
-                } else {
-                    cleanedBlock = replaceChars(cleanedBlock);
-                    sortedBlock = "[" + sortString(cleanedBlock) + "]";
-                    sortedBlock = replaceCharsBack(sortedBlock);
-                }
-            } else {
-                sortedBlock = block;
+            if (ch == '[') {
+                output.push_back(ch);
+                last = ch;
+                continue;
+            }
+            if (ch == ']' && last != '\\') {
+                output.push_back(ch);
+                sortBlock(output, blockStart, present);
+                inBlock = false;
+                continue;
+            }
+            if (closes) {
+                output.resize(blockStart);
+                inBlock = false;
+                continue;
             }
 
-            sortedBlocks.push_back(sortedBlock);
+            const uint8_t kind = kindOf(ch);
+            if (kind != 0 && (present & conflictsOf(kind)) != 0) {
+                // 混合了数字、字母与字母数字：在此处拆分出新的子块
+                output.push_back(']');
+                sortBlock(output, blockStart, present);
+                blockStart = output.size();
+                output.push_back('[');
+                present = 0;
+            }
+            output.push_back(ch);
+            present |= markOf(ch);
+            last = ch;
         }
 
-        return join(sortedBlocks); // Ensure this is returning std::vector<std::string>
+        if (inBlock) {
+            output.resize(blockStart);
+        }
     }
 
-    void checkOpenBraces(const std::string &inputString) {
+private:
+    // 记录某个字符是否出现过的位
+    static constexpr uint8_t Zero = 1 << 0;
+    static constexpr uint8_t Nine = 1 << 1;
+    static constexpr uint8_t UpperA = 1 << 2;
+    static constexpr uint8_t LowerA = 1 << 3;
+    static constexpr uint8_t Dash = 1 << 4;
+    static constexpr uint8_t Underscore = 1 << 5;
+
+    // 字符分类
+    static constexpr uint8_t Digit = 1;
+    static constexpr uint8_t Alpha = 2;
+    static constexpr uint8_t Special = 3;
+
+    /**
+     * Validation of `[` and `{` blocks, fed one character at a time.
+     */
+    struct BraceCheck {
         bool escape = false;
         bool squareBraceOpen = false;
         bool curlyBraceOpen = false;
 
-        for (const char &ch : inputString) {
+        constexpr void check(char ch) {
             if (ch == '\\') {
                 escape = !escape;
-                continue;
+                return;
             }
-
             if (ch == '[') {
                 if (squareBraceOpen) {
                     throw FormatError();
                 }
                 squareBraceOpen = !escape;
             }
-
             if (ch == ']' && !escape) {
                 squareBraceOpen = false;
             }
-
             if (ch == '{') {
                 if (curlyBraceOpen) {
                     throw FormatError();
                 }
                 curlyBraceOpen = !escape;
             }
-
             if (ch == '}' && !escape) {
                 curlyBraceOpen = false;
             }
             escape = false;
         }
+    };
+
+    static constexpr uint8_t kindOf(char ch) {
+        if (ch >= '0' && ch <= '9') {
+            return Digit;
+        }
+        if ((ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z')) {
+            return Alpha;
+        }
+        if (ch == '-' || ch == '_') {
+            return Special;
+        }
+        return 0;
     }
 
-private:
-    bool startsWith(const std::string &str, const std::string &prefix) const { return str.rfind(prefix, 0) == 0; }
+    // 与给定分类的字符不能出现在同一个子块中的标记
+    static constexpr uint8_t conflictsOf(uint8_t kind) {
+        switch (kind) {
+        case Digit:
+            return UpperA | LowerA | Dash | Underscore;
+        case Alpha:
+            return Zero | Nine | Dash | Underscore;
+        default:
+            return Zero | Nine | UpperA | LowerA;
+        }
+    }
+
+    static constexpr uint8_t markOf(char ch) {
+        switch (ch) {
+        case '0':
+            return Zero;
+        case '9':
+            return Nine;
+        case 'A':
+            return UpperA;
+        case 'a':
+            return LowerA;
+        case '-':
+            return Dash;
+        case '_':
+            return Underscore;
+        default:
+            return 0;
+        }
+    }
+
+    /**
+     * Sort the characters of the closed block `output[start..]` in place.
+     *
+     * Blocks with `0`, `9`, `A` or `a` are sorted by byte value. Other blocks rank `_` as `A` and
+     * `-` as `a`, so mandatory alphanumerics come first. The first ellipsis stays whole and moves
+     * to the end of the block.
+     */
+    template <typename Output>
+    static constexpr void sortBlock(Output &output, size_t start, uint8_t present) {
+        size_t begin = start + 1;
+        size_t end = output.size() - 1;
+        for (size_t i = begin; i + EllipsisSymbolLength <= end; ++i) {
+            if (isEllipsisAt(output, i)) {
+                // 把省略号整体移到块尾
+                for (size_t j = i; j + EllipsisSymbolLength < end; ++j) {
+                    output[j] = output[j + EllipsisSymbolLength];
+                }
+                end -= EllipsisSymbolLength;
+                for (size_t k = 0; k < EllipsisSymbolLength; ++k) {
+                    output[end + k] = EllipsisSymbol[k];
+                }
+                break;
+            }
+        }
+        const bool remap = (present & (Zero | Nine | UpperA | LowerA)) == 0;
+        if (end - begin <= InsertionSortLimit) {
+            insertionSort(output, begin, end, remap);
+        } else {
+            countingSort(output, begin, end, remap);
+        }
+    }
+
+    template <typename Output>
+    static constexpr bool isEllipsisAt(const Output &output, size_t index) {
+        for (size_t k = 0; k < EllipsisSymbolLength; ++k) {
+            if (output[index + k] != EllipsisSymbol[k]) {
+                return false;
+            }
+        }
+        return true;
+    }
 
-    std::string sortString(std::string str) {
-        std::sort(str.begin(), str.end());
-        return str;
+    // 排序键保持 char 自身的大小顺序（与 std::sort 一致），并可把 _ 和 - 视为 A 和 a
+    static constexpr uint8_t sortKeyOf(char ch, bool remap) {
+        if (remap && ch == '_') {
+            ch = 'A';
+        } else if (remap && ch == '-') {
+            ch = 'a';
+        }
+        return static_cast<uint8_t>(ch - CHAR_MIN);
     }
 
-    std::string replaceChars(const std::string &str) {
-        std::string newStr = str;
-        std::replace(newStr.begin(), newStr.end(), '_', 'A');
-        std::replace(newStr.begin(), newStr.end(), '-', 'a');
-        return newStr;
+    static constexpr char characterOf(unsigned key, bool remap) {
+        const char ch = static_cast<char>(static_cast<int>(key) + CHAR_MIN);
+        if (remap && ch == 'A') {
+            return '_';
+        }
+        if (remap && ch == 'a') {
+            return '-';
+        }
+        return ch;
     }
 
-    std::string replaceCharsBack(const std::string &str) {
-        std::string newStr = str;
-        std::replace(newStr.begin(), newStr.end(), 'A', '_');
-        std::replace(newStr.begin(), newStr.end(), 'a', '-');
-        return newStr;
+    // 短块直接插入排序
+    static constexpr size_t InsertionSortLimit = 16;
+
+    template <typename Output>
+    static constexpr void insertionSort(Output &output, size_t begin, size_t end, bool remap) {
+        for (size_t i = begin + 1; i < end; ++i) {
+            const char ch = output[i];
+            const uint8_t key = sortKeyOf(ch, remap);
+            size_t j = i;
+            for (; j > begin && sortKeyOf(output[j - 1], remap) > key; --j) {
+                output[j] = output[j - 1];
+            }
+            output[j] = ch;
+        }
     }
-    std::string join(const std::vector<std::string> &strings) {
-        std::string result;
-        for (const auto &str : strings) {
-            result += str; // 将所有块连接成一个字符串
+
+    // 计数排序，只输出块内出现过的字符区间
+    template <typename Output>
+    static constexpr void countingSort(Output &output, size_t begin, size_t end, bool remap) {
+        std::array<uint32_t, 256> counts{};
+        uint8_t lowest = UINT8_MAX;
+        uint8_t highest = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const uint8_t key = sortKeyOf(output[i], remap);
+            lowest = std::min(lowest, key);
+            highest = std::max(highest, key);
+            counts[key] += 1;
+        }
+        size_t out = begin;
+        for (unsigned key = lowest; key <= highest; ++key) {
+            for (uint32_t n = counts[key]; n > 0; --n) {
+                output[out++] = characterOf(key, remap);
+            }
         }
-        return result;
     }
 };
-} // namespace TinpMask
\ No newline at end of file
+} // namespace TinpMask
@@ -1,12 +1,25 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <map>
 #include <memory>
+#include "model/BackwardOutput.h"
 #include "model/CaretStringIterator.h"
+#include "model/RTLCaretStringIterator.h"
 #include "model/common.h" // 假设这些头文件定义了相关类
 #include "Compiler.h"
 #include "model/State.h"
+#include "model/StateArena.h"
+#include "model/Program.h"
+#include "ApplySession.h"
+#include "MaskCache.h"
+#include "MaskOutput.h"
+#include "PrebuiltMasks.h"
+#include "ProgramStore.h"
 
 namespace TinpMask {
 
@@ -15,10 +28,21 @@ namespace TinpMask {
         std::vector<Notation> customNotations;
 
     private:
-        std::shared_ptr<State> initialState;
+        std::string format;
+
+    protected:
+        // 运行时编译的结果；预编译掩码的程序位于静态存储中，此对象为空
+        Program program;
+        // apply 解释执行的程序，指向 program 或 StaticProgram
+        ProgramView code;
+        // 编译结果的唯一标识，用于判断 ApplySession 中的检查点是否属于本 Mask
+        uint64_t identity = nextIdentity();
 
     private:
-        std::string format;
+        static uint64_t nextIdentity() {
+            static std::atomic<uint64_t> counter{0};
+            return ++counter;
+        }
 
     public:
         // 主构造函数
@@ -26,41 +50,63 @@ namespace TinpMask {
             : customNotations(customNotations) {
             this->format = format;
             this->customNotations = customNotations;
-            this->initialState = Compiler(customNotations).compile(format);
+            // 状态图只是编译的中间结果，汇编出 program 后随 states 一起释放
+            StateArena states;
+            Compiler compiler(customNotations);
+            this->program = compiler.assemble(compiler.compile(format, states));
+            this->code = this->program.view();
         }
 
         // 便利构造函数
-        Mask(const std::string &format) : Mask(format, {}) { // 调用主构造函数，传入空的 customNotations
-            std::vector<Notation> emptyVector;
-            this->format = format;
-            this->customNotations = emptyVector;
-            this->initialState = Compiler(this->customNotations).compile(this->format);
-        }
+        Mask(const std::string &format) : Mask(format, {}) {} // 调用主构造函数，传入空的 customNotations
 
+        // code 指向自身的 program，拷贝后会悬空
+        Mask(const Mask &) = delete;
+        Mask &operator=(const Mask &) = delete;
 
-        class MaskFactory {
-        public:
-            static std::unordered_map<std::string, std::shared_ptr<Mask>> maskCache;
+    protected:
+        // 预编译或从 ProgramStore 映射的掩码：直接使用已有的程序，不做任何编译
+        Mask(std::string_view format, const ProgramView &code) : format(format), code(code) {}
 
+    public:
+
+
+        class MaskFactory {
         public:
             /**
              * Factory constructor.
              *
-             * Operates over own ``Mask`` cache where initialized ``Mask`` objects are stored under
-             * corresponding format key: `[format : mask]`
+             * Formats listed in ``PrebuiltMasks`` are served from their static programs when there are no
+             * custom notations. Everything else goes through the shared ``MaskCache`` where initialized
+             * ``Mask`` objects are stored under the key of their format, custom notations and direction.
+             * On a cache miss, a program found in ``ProgramStore`` is used instead of compiling; newly
+             * compiled programs are recorded there.
              *
              * @returns Previously cached ``Mask`` object for requested format string. If such it
              * doesn't exist in cache, the object is constructed, cached and returned.
              */
             static std::shared_ptr<Mask> getOrCreate(const std::string &format,
                                                      const std::vector<Notation> &customNotations) {
-                auto cachedMask = maskCache.find(format);
-                if (cachedMask == maskCache.end()) {
-                    auto newMask = std::make_shared<Mask>(format, customNotations);
-                    maskCache[format] = newMask;
-                    return newMask;
+                if (customNotations.empty()) {
+                    const int prebuilt = PrebuiltMasks::indexOf(format);
+                    if (prebuilt >= 0) {
+                        return prebuiltMask(static_cast<size_t>(prebuilt));
+                    }
+                }
+                std::string key = MaskCache::key(format, customNotations, false);
+                if (auto cachedMask = MaskCache::shared().find(key)) {
+                    return cachedMask;
                 }
-                return cachedMask->second;
+                std::shared_ptr<Mask> newMask;
+                ProgramView stored;
+                if (ProgramStore::shared().find(key, stored)) {
+                    newMask = std::shared_ptr<Mask>(new Mask(format, stored));
+                } else {
+                    newMask = std::make_shared<Mask>(format, customNotations);
+                    ProgramStore::shared().record(key, newMask->program);
+                }
+                size_t bytes = newMask->footprint();
+                return MaskCache::shared().insert(key, std::move(newMask), bytes);
             }
 
             /**
@@ -80,6 +126,20 @@ namespace TinpMask {
                     return false;
                 }
             }
+
+        private:
+            // 预编译掩码常驻进程，不进入 MaskCache
+            static const std::shared_ptr<Mask> &prebuiltMask(size_t index) {
+                static const auto *masks = [] {
+                    auto *result = new std::array<std::shared_ptr<Mask>, PrebuiltMasks::Count>();
+                    for (size_t i = 0; i < PrebuiltMasks::Count; ++i) {
+                        const PrebuiltMasks::Entry &entry = PrebuiltMasks::Entries[i];
+                        (*result)[i] = std::shared_ptr<Mask>(new Mask(entry.format, entry.program));
+                    }
+                    return result;
+                }();
+                return (*masks)[index];
+            }
         };
         /**
          * Apply mask to the user input string.
@@ -88,284 +148,473 @@ namespace TinpMask {
          *
          * @returns Formatted text with extracted value an adjusted cursor position.
          */
-      virtual Result apply(const CaretString &text)    {
-            auto iterator = makeIterator(text); // Assume this function is defined
-
-            int affinity = 0;
-            std::string extractedValue;
-            std::string modifiedString;
-            int modifiedCaretPosition = text.caretPosition;
-
-            std::shared_ptr<State> state = initialState;
-            AutocompletionStack autocompletionStack;
+        Result apply(const CaretString &text) {
+            MaskOutput output;
+            applyInto(text, output);
+            return std::move(output.result);
+        }
 
-            bool insertionAffectsCaret = iterator->insertionAffectsCaret();
-            bool deletionAffectsCaret = iterator->deletionAffectsCaret();
-            char character = iterator->next();
-            while (character != '\0') {
-                auto next = state->accept(character);
+        /**
+         * Apply mask to the user input string, writing into caller-owned buffers.
+         *
+         * The strings of `output.result` are cleared and reserved up to ``maxTextLength`` and
+         * ``maxValueLength`` for `text`, so reusing one `output` across calls avoids reallocation.
+         *
+         * @returns `output.result`, valid until `output` is used again.
+         */
+        virtual const Result &applyInto(const CaretString &text, MaskOutput &output) {
+            Result &result = output.result;
+            std::string &modifiedString = result.formattedText.string;
+            std::string &extractedValue = result.extractedValue;
+            modifiedString.clear();
+            extractedValue.clear();
+            modifiedString.reserve(maxTextLength(text.string.length()));
+            extractedValue.reserve(maxValueLength(text.string.length()));
+            AutocompletionStack &autocompletionStack = output.stackFor(code.autocompletableCount);
+
+            Checkpoint registers;
+            bool insertionAffectsCaret = scanWithGravity<CaretStringIterator>(text, 0, registers, modifiedString, extractedValue,
+                                                     autocompletionStack, [](const Checkpoint &) {});
+            finish(text, text.caretPosition, registers, insertionAffectsCaret, autocompletionStack, modifiedString,
+                   extractedValue, result.formattedText.caretPosition, result.complete, result.tailPlaceholder);
+            result.formattedText.caretGravity = text.caretGravity;
+            result.affinity = registers.affinity;
+            return result;
+        }
 
-                if (next != nullptr) {
-                    if (deletionAffectsCaret) {
-                        auto opt = state->autocomplete();
-                        if (opt != nullptr) {
-                            autocompletionStack.push(*opt);
-                        }
-                    }
-                    state = next->state;
-                    if (next->insert == '\0') {
-                        modifiedString += "";
-                    } else {
-                        modifiedString += next->insert;
-                    }
-                    if (next->value == '\0') {
-                        extractedValue += "";
-                    } else {
-                        extractedValue += next->value;
-                    }
-                    if (next->pass) {
-                        insertionAffectsCaret = iterator->insertionAffectsCaret();
-                        deletionAffectsCaret = iterator->deletionAffectsCaret();
-                        character = iterator->next();
-                        affinity += 1;
-                    } else {
-                        if (insertionAffectsCaret && next->insert != '\0') {
-                            modifiedCaretPosition += 1;
-                        }
-                        affinity -= 1;
-                    }
-                } else {
-                    if (deletionAffectsCaret) {
-                        modifiedCaretPosition -= 1;
-                    }
-                    insertionAffectsCaret = iterator->insertionAffectsCaret();
-                    deletionAffectsCaret = iterator->deletionAffectsCaret();
-                    character = iterator->next();
-                    affinity -= 1;
-                }
-            }
+        /**
+         * Upper bound of the formatted text length for an input of `inputLength` bytes.
+         *
+         * Every instruction emits at most one character, except an ellipsis, which emits at most
+         * one per input character.
+         */
+        size_t maxTextLength(size_t inputLength) const {
+            return code.suffix(0).totalTextLength + (code.elliptical() ? inputLength : 0);
+        }
 
-            while (text.caretGravity->autocomplete() && insertionAffectsCaret) {
-                auto next = state->autocomplete();
-                if (next == nullptr)
-                    break;
+        // 提取值长度的上界，规则同 maxTextLength
+        size_t maxValueLength(size_t inputLength) const {
+            return code.suffix(0).totalValueLength + (code.elliptical() ? inputLength : 0);
+        }
 
-                state = next->state;
-                if (next->insert == '\0') {
-                    modifiedString += "";
-                } else {
-                    modifiedString += next->insert;
-                }
-                if (next->value == '\0') {
-                    extractedValue += "";
-                } else {
-                    extractedValue += next->value;
-                }
-                if (next->insert == '\0') {
-                    modifiedCaretPosition += 1;
-                }
+        /**
+         * Apply mask to the user input string, reusing the work of the previous call made with the
+         * same session.
+         *
+         * Scanning resumes from the first position where `text` differs from the previous input of
+         * the session (and not past either caret position), so the usual keystroke costs O(edit).
+         *
+         * @param text user input string with current cursor position
+         * @param session incremental state of the text field, bound to this mask on first use
+         *
+         * @returns Same result as ``apply(text)``, stored inside the session.
+         */
+        virtual const Result &apply(const CaretString &text, ApplySession &session) {
+            using Kind = CaretString::CaretGravity::Kind;
+            const CaretString::CaretGravity *gravity = text.caretGravity.get();
+            const Kind kind = gravity != nullptr ? gravity->kind() : Kind::Custom;
+            const bool autocomplete = gravity != nullptr && gravity->autocomplete();
+            const bool autoskip = gravity != nullptr && gravity->autoskip();
+            if (session.maskIdentity != identity) {
+                session.maskIdentity = identity;
+                session.autocompletionStack = std::make_unique<AutocompletionStack>(code.autocompletableCount);
+                session.checkpoints.clear();
+                session.input.clear();
+            } else if (session.gravity != kind || session.autocomplete != autocomplete || session.autoskip != autoskip) {
+                // 检查点中的光标偏移按上一次的重力计算
+                session.checkpoints.clear();
+                session.input.clear();
             }
-            std::shared_ptr<State> tailState = state;
-            std::string tail;
-            while (text.caretGravity->autoskip() && !autocompletionStack.isEmpty()) {
-                auto skip = autocompletionStack.pop();
-                if (modifiedString.length() == modifiedCaretPosition) {
-                    if (!skip->insert == '\0' && skip->insert == modifiedString.back()) {
-                        modifiedString.pop_back();
-                        modifiedCaretPosition -= 1;
-                    }
-                    if (skip.has_value() && skip.value().value == modifiedString.back()) {
-                        extractedValue.pop_back();
-                    }
-                } else {
-                    if (!skip->insert == '\0') {
-                        modifiedCaretPosition -= 1;
-                    }
+            session.gravity = kind;
+            session.autocomplete = autocomplete;
+            session.autoskip = autoskip;
+
+            size_t position = 0;
+            if (!session.checkpoints.empty()) {
+                // 光标之前的位置上，插入与删除始终影响光标，与光标的具体位置无关，因此检查点可以复用
+                size_t limit = std::min({session.checkpoints.size() - 1, session.input.length(), text.string.length(),
+                                         static_cast<size_t>(std::max(0, session.caretPosition)),
+                                         static_cast<size_t>(std::max(0, text.caretPosition))});
+                while (position < limit && text.string[position] == session.input[position]) {
+                    position += 1;
                 }
-                tailState = skip->state;
-                tail += skip->insert;
             }
 
-            std::string tailPlaceholder = appendPlaceholder(tailState.get(), tail); // Assume this function is defined
+            Checkpoint registers = session.checkpoints.empty() ? Checkpoint() : session.checkpoints[position];
+            session.checkpoints.resize(position);
+            session.output.resize(registers.outputLength);
+            session.value.resize(registers.valueLength);
+            session.autocompletionStack->truncate(registers.stackDepth);
+            session.output.reserve(maxTextLength(text.string.length()));
+            session.value.reserve(maxValueLength(text.string.length()));
+            bool insertionAffectsCaret =
+                scanWithGravity<CaretStringIterator>(text, position, registers, session.output, session.value, *session.autocompletionStack,
+                            [&session](const Checkpoint &checkpoint) { session.checkpoints.push_back(checkpoint); });
+            session.input.replace(position, std::string::npos, text.string, position, std::string::npos);
+            session.caretPosition = text.caretPosition;
+
+            Result &result = session.result;
+            result.formattedText.string = session.output;
+            result.formattedText.caretGravity = text.caretGravity;
+            result.extractedValue = session.value;
+            result.affinity = registers.affinity;
+            finish(text, text.caretPosition, registers, insertionAffectsCaret, *session.autocompletionStack,
+                   result.formattedText.string,
+                   result.extractedValue, result.formattedText.caretPosition, result.complete, result.tailPlaceholder);
+            return result;
+        }
 
-            return Result(CaretString(modifiedString, modifiedCaretPosition, text.caretGravity), extractedValue,
-                          affinity,
-                          noMandatoryCharactersLeftAfterState(state.get()), // Assume this function is defined
-                          tailPlaceholder);
+    protected:
+        /**
+         * Right-to-left ``apply`` for a mask compiled from the reversed format (see ``RTLMask``).
+         *
+         * Reads `text` from its end through ``RTLCaretStringIterator`` and writes the output back to
+         * front with ``BackwardOutput``, so `result` comes out in reading order without reversing the
+         * input or the result. Reuses the capacity of the strings in `result`.
+         */
+        void applyBackward(const CaretString &text, AutocompletionStack &autocompletionStack, Result &result) const {
+            BackwardOutput modifiedString(result.formattedText.string, maxTextLength(text.string.length()));
+            BackwardOutput extractedValue(result.extractedValue, maxValueLength(text.string.length()));
+            autocompletionStack.truncate(0);
+
+            Checkpoint registers;
+            bool insertionAffectsCaret =
+                scanWithGravity<RTLCaretStringIterator>(text, 0, registers, modifiedString, extractedValue,
+                                                        autocompletionStack, [](const Checkpoint &) {});
+
+            // 扫描方向上的光标从末尾算起，结果中再换算回来
+            const int caretFromEnd = static_cast<int>(text.string.length()) - text.caretPosition;
+            int caretPosition = 0;
+            finish(text, caretFromEnd, registers, insertionAffectsCaret, autocompletionStack, modifiedString,
+                   extractedValue, caretPosition, result.complete, result.tailPlaceholder);
+            modifiedString.commit();
+            extractedValue.commit();
+            std::reverse(result.tailPlaceholder.begin(), result.tailPlaceholder.end());
+            result.formattedText.caretPosition = static_cast<int>(result.formattedText.string.length()) - caretPosition;
+            result.formattedText.caretGravity = text.caretGravity;
+            result.affinity = registers.affinity;
         }
 
+        // ``applyBackward`` into caller-owned buffers
+        const Result &applyBackward(const CaretString &text, MaskOutput &output) const {
+            applyBackward(text, output.stackFor(code.autocompletableCount), output.result);
+            return output.result;
+        }
 
-    public:
-        std::shared_ptr<CaretStringIterator> makeIterator(const CaretString &text) const {
-            return std::make_shared<CaretStringIterator>(text);
+        /**
+         * ``applyBackward`` into `session`. The session keeps no checkpoints: typing at the end of the
+         * text changes the start of the right-to-left scan, so there is nothing to resume.
+         */
+        const Result &applyBackward(const CaretString &text, ApplySession &session) const {
+            if (session.maskIdentity != identity) {
+                session.maskIdentity = identity;
+                session.autocompletionStack = std::make_unique<AutocompletionStack>(code.autocompletableCount);
+                session.input.clear();
+            }
+            session.checkpoints.clear();
+            applyBackward(text, *session.autocompletionStack, session.result);
+            return session.result;
         }
 
+    public:
         /**
          * Generate placeholder.
          *
          * @return Placeholder string.
          */
     public:
-        std::string placeholder() { return appendPlaceholder(initialState.get(), ""); }
+        std::string placeholder() const {
+            std::string result;
+            code.appendPlaceholder(0, result);
+            return result;
+        }
+
         /**
-         * Minimal length of the text inside the field to fill all mandatory characters in the mask.
+         * Approximate memory taken by this compiled mask, in bytes.
          *
-         * @return Minimal satisfying count of characters inside the text field.
+         * Used by ``MaskCache`` to enforce its byte budget.
          */
-    public:
-        int acceptableTextLength() {
-            std::shared_ptr<State> state = std::move(initialState);
-            ;
-            int length = 0;
-
-            while (state != nullptr && dynamic_cast<EOLState *>(state.get()) == nullptr) {
-                if (dynamic_cast<FixedState *>(state.get()) != nullptr ||
-                    dynamic_cast<FreeState *>(state.get()) != nullptr ||
-                    dynamic_cast<ValueState *>(state.get()) != nullptr) {
-                    length += 1;
-                }
-                state = state->child; // 移动到下一个子状态
+        size_t footprint() const {
+            size_t bytes = sizeof(*this) + format.capacity();
+            for (const Notation &notation : customNotations) {
+                bytes += sizeof(Notation) + notation.characterSet.capacity();
             }
-
-            return length;
+            bytes += program.instructions.capacity() * sizeof(Instruction);
+            bytes += program.characterClasses.capacity() * sizeof(CharacterClass);
+            bytes += program.placeholders.capacity() + program.suffixes.capacity() * sizeof(Suffix);
+            return bytes;
         }
 
+        /**
+         * Debug representation of the compiled state graph.
+         *
+         * The graph is not kept after compilation; it is compiled again from the format on each
+         * call. Masks built from a precompiled or stored program have no format to compile from and
+         * print `null`.
+         */
+        std::string toString() const {
+            if (program.instructions.empty()) {
+                return "null";
+            }
+            StateArena states;
+            return Compiler(customNotations).compile(format, states)->toString();
+        }
+        /**
+         * Minimal length of the text inside the field to fill all mandatory characters in the mask.
+         *
+         * @return Minimal satisfying count of characters inside the text field.
+         */
+        int acceptableTextLength() const { return static_cast<int>(code.suffix(0).acceptableTextLength); }
 
         /**
          * Maximal length of the text inside the field.
          *
          * @return Total available count of mandatory and optional characters inside the text field.
          */
-    public:
-        int totalTextLength() const {
-            std::shared_ptr<State> state = initialState;
-            ;
-            int length = 0;
-
-            while (state != nullptr && dynamic_cast<EOLState *>(state.get()) == nullptr) {
-                if (dynamic_cast<FixedState *>(state.get()) != nullptr ||
-                    dynamic_cast<FreeState *>(state.get()) != nullptr ||
-                    dynamic_cast<ValueState *>(state.get()) != nullptr ||
-                    dynamic_cast<OptionalValueState *>(state.get()) != nullptr) {
-                    length += 1;
-                }
-                state = state->child; // 移动到下一个子状态
-            }
+        int totalTextLength() const { return static_cast<int>(code.suffix(0).totalTextLength); }
 
-            return length;
-        }
         /**
-         * Minimal length of the extracted value with all mandatory characters filled.\
+         * Minimal length of the extracted value with all mandatory characters filled.
          *
          * @return Minimal satisfying count of characters in extracted value.
          */
-    public:
-        int acceptableValueLength() const {
-            std::shared_ptr<State> state = initialState;
-            int length = 0;
-            while (state != nullptr && dynamic_cast<EOLState *>(state.get()) == nullptr) {
-                if (dynamic_cast<FixedState *>(state.get()) != nullptr ||
-                    dynamic_cast<ValueState *>(state.get()) != nullptr) {
-                    length += 1;
-                }
-                state = state->child; // 移动到下一个子状态
-            }
+        int acceptableValueLength() const { return static_cast<int>(code.suffix(0).acceptableValueLength); }
 
-            return length;
-        }
         /**
          * Maximal length of the extracted value.
          *
          * @return Total available count of mandatory and optional characters for extracted value.
          */
-    public:
-        int totalValueLength() const {
-            std::shared_ptr<State> state = initialState;
-            int length = 0;
-            while (state != nullptr && dynamic_cast<EOLState *>(state.get()) == nullptr) {
-                if (dynamic_cast<FixedState *>(state.get()) != nullptr ||
-                    dynamic_cast<ValueState *>(state.get()) != nullptr ||
-                    dynamic_cast<OptionalValueState *>(state.get()) != nullptr) {
-                    length += 1;
-                }
-                state = state->child; // 移动到下一个子状态
+        int totalValueLength() const { return static_cast<int>(code.suffix(0).totalValueLength); }
+
+    private:
+        /**
+         * ``scan`` with the caret rule of `text`'s gravity, reading through `Iterator`
+         * (``CaretStringIterator`` or ``RTLCaretStringIterator``).
+         *
+         * The gravity is inspected once here; each branch runs a ``scan`` instantiated for that
+         * rule, so the loop itself does no dynamic dispatch.
+         */
+        template <template <CaretString::CaretGravity::Kind> class Iterator, typename Output, typename OnCheckpoint>
+        bool scanWithGravity(const CaretString &text, size_t position, Checkpoint &registers, Output &modifiedString,
+                             Output &extractedValue, AutocompletionStack &autocompletionStack,
+                             OnCheckpoint &&onCheckpoint) const {
+            using Kind = CaretString::CaretGravity::Kind;
+            const Kind gravity = text.caretGravity != nullptr ? text.caretGravity->kind() : Kind::Custom;
+            switch (gravity) {
+            case Kind::Forward:
+                return scan<Iterator<Kind::Forward>>(text, position, registers, modifiedString, extractedValue,
+                                                     autocompletionStack, onCheckpoint);
+            case Kind::Backward:
+                return scan<Iterator<Kind::Backward>>(text, position, registers, modifiedString, extractedValue,
+                                                      autocompletionStack, onCheckpoint);
+            default:
+                return scan<Iterator<Kind::Custom>>(text, position, registers, modifiedString, extractedValue,
+                                                    autocompletionStack, onCheckpoint);
             }
-            return length;
         }
 
-    private:
-        std::string appendPlaceholder(State *state, const std::string &placeholder) const {
-            if (state == nullptr) {
-                return placeholder;
+        /**
+         * Main scan loop of ``apply``.
+         *
+         * Reads `text` from `position` on, starting with `registers`, and appends to the output
+         * strings and the autocompletion stack. `onCheckpoint` receives the registers each time
+         * a new input character is about to be processed, and once more at the end of the input.
+         *
+         * @returns Whether insertion affects the caret at the end of the input.
+         */
+        template <typename Iterator, typename Output, typename OnCheckpoint>
+        bool scan(const CaretString &text, size_t position, Checkpoint &registers, Output &modifiedString,
+                  Output &extractedValue, AutocompletionStack &autocompletionStack,
+                  OnCheckpoint &&onCheckpoint) const {
+            Iterator iterator(text, static_cast<int>(position));
+            Transition next;
+
+            auto checkpoint = [&]() {
+                registers.outputLength = static_cast<uint32_t>(modifiedString.length());
+                registers.valueLength = static_cast<uint32_t>(extractedValue.length());
+                registers.stackDepth = static_cast<uint32_t>(autocompletionStack.size());
+                onCheckpoint(registers);
+            };
+
+            bool insertionAffectsCaret = iterator.insertionAffectsCaret();
+            bool deletionAffectsCaret = iterator.deletionAffectsCaret();
+            char character = iterator.next();
+            checkpoint();
+            while (character != '\0') {
+                if constexpr (Iterator::ReadsForward) {
+                    if (code.suffix(registers.state).literalRunLength > 1 &&
+                        character == code.placeholders[registers.state]) {
+                        character = scanLiteralRun(iterator, registers, insertionAffectsCaret, deletionAffectsCaret,
+                                                   modifiedString, extractedValue, autocompletionStack, onCheckpoint);
+                        continue;
+                    }
+                }
+                if (code.accept(registers.state, character, next)) {
+                    if (deletionAffectsCaret) {
+                        Transition skip;
+                        if (code.autocomplete(registers.state, skip)) {
+                            autocompletionStack.push(skip);
+                        }
+                    }
+                    registers.state = next.state;
+                    if (next.insert != '\0') {
+                        modifiedString += next.insert;
+                    }
+                    if (next.value != '\0') {
+                        extractedValue += next.value;
+                    }
+                    if (next.pass) {
+                        insertionAffectsCaret = iterator.insertionAffectsCaret();
+                        deletionAffectsCaret = iterator.deletionAffectsCaret();
+                        character = iterator.next();
+                        registers.affinity += 1;
+                        checkpoint();
+                    } else {
+                        if (insertionAffectsCaret && next.insert != '\0') {
+                            registers.caretShift += 1;
+                        }
+                        registers.affinity -= 1;
+                    }
+                } else {
+                    if (deletionAffectsCaret) {
+                        registers.caretShift -= 1;
+                    }
+                    insertionAffectsCaret = iterator.insertionAffectsCaret();
+                    deletionAffectsCaret = iterator.deletionAffectsCaret();
+                    character = iterator.next();
+                    registers.affinity -= 1;
+                    checkpoint();
+                }
             }
+            return insertionAffectsCaret;
+        }
 
-            if (dynamic_cast<EOLState *>(state)) {
-                return placeholder;
+        /**
+         * Fast path of ``scan`` for a run of Fixed or Free instructions whose first character has
+         * just been read and matched.
+         *
+         * Compares the rest of the run with the unread input at once and appends every matched
+         * character in one go, which is the usual case for pasted, already formatted text. Caret
+         * flags, autocompletion entries and checkpoints are still recorded per character, exactly as
+         * ``ProgramView::accept`` would, and the scan goes on one instruction at a time from the first
+         * mismatch. Instruction indices are unchanged, so session checkpoints stay valid.
+         *
+         * @returns The first character after the matched part of the run.
+         */
+        template <typename Iterator, typename OnCheckpoint>
+        char scanLiteralRun(Iterator &iterator, Checkpoint &registers, bool &insertionAffectsCaret,
+                            bool &deletionAffectsCaret, std::string &modifiedString, std::string &extractedValue,
+                            AutocompletionStack &autocompletionStack, OnCheckpoint &&onCheckpoint) const {
+            const uint32_t start = registers.state;
+            const char *literal = code.placeholders + start;
+            const size_t matched = 1 + iterator.matchLength(literal + 1, code.suffix(start).literalRunLength - 1);
+            const bool fixed = code.at(start).kind == InstructionKind::Fixed; // Fixed 的字符同时写入提取值
+
+            const size_t outputLength = modifiedString.length();
+            const size_t valueLength = extractedValue.length();
+            modifiedString.append(literal, matched);
+            if (fixed) {
+                extractedValue.append(literal, matched);
             }
 
-            if (auto fixedState = dynamic_cast<FixedState *>(state)) {
-                return appendPlaceholder(fixedState->child.get(), placeholder + fixedState->ownCharacter);
+            char character = '\0';
+            for (size_t i = 0; i < matched; ++i) {
+                if (deletionAffectsCaret) {
+                    autocompletionStack.push({static_cast<uint32_t>(start + i + 1), literal[i], false,
+                                              fixed ? literal[i] : '\0'});
+                }
+                registers.state = static_cast<uint32_t>(start + i + 1);
+                insertionAffectsCaret = iterator.insertionAffectsCaret();
+                deletionAffectsCaret = iterator.deletionAffectsCaret();
+                character = iterator.next();
+                registers.affinity += 1;
+                registers.outputLength = static_cast<uint32_t>(outputLength + i + 1);
+                registers.valueLength = static_cast<uint32_t>(fixed ? valueLength + i + 1 : valueLength);
+                registers.stackDepth = static_cast<uint32_t>(autocompletionStack.size());
+                onCheckpoint(registers);
             }
+            return character;
+        }
 
-            if (auto freeState = dynamic_cast<FreeState *>(state)) {
-                return appendPlaceholder(freeState->child.get(), placeholder + freeState->ownCharacter);
+        /**
+         * Autocompletion and autoskip steps of ``apply``, performed after the main scan.
+         *
+         * Modifies the scan output in place; the autocompletion stack is left untouched so that
+         * incremental sessions can keep it. `textCaretPosition` is the caret of `text` in scan order.
+         */
+        template <typename Output>
+        void finish(const CaretString &text, int textCaretPosition, const Checkpoint &registers,
+                    bool insertionAffectsCaret, const AutocompletionStack &autocompletionStack, Output &modifiedString,
+                    Output &extractedValue, int &caretPosition, bool &complete, std::string &tailPlaceholder) const {
+            // 重力的两个开关各读取一次，选定特化版本
+            const CaretString::CaretGravity *gravity = text.caretGravity.get();
+            const bool autocomplete = gravity != nullptr && gravity->autocomplete();
+            const bool autoskip = gravity != nullptr && gravity->autoskip();
+            if (autocomplete && autoskip) {
+                finishWith<true, true>(textCaretPosition, registers, insertionAffectsCaret, autocompletionStack,
+                                       modifiedString, extractedValue, caretPosition, complete, tailPlaceholder);
+            } else if (autocomplete) {
+                finishWith<true, false>(textCaretPosition, registers, insertionAffectsCaret, autocompletionStack,
+                                        modifiedString, extractedValue, caretPosition, complete, tailPlaceholder);
+            } else if (autoskip) {
+                finishWith<false, true>(textCaretPosition, registers, insertionAffectsCaret, autocompletionStack,
+                                        modifiedString, extractedValue, caretPosition, complete, tailPlaceholder);
+            } else {
+                finishWith<false, false>(textCaretPosition, registers, insertionAffectsCaret, autocompletionStack,
+                                         modifiedString, extractedValue, caretPosition, complete, tailPlaceholder);
             }
+        }
 
-            if (auto optionalValueState = dynamic_cast<OptionalValueState *>(state)) {
-                if (!state) {
-                    return placeholder; // 如果 state 为 nullptr，直接返回原始 placeholder
+        template <bool Autocomplete, bool Autoskip, typename Output>
+        void finishWith(int textCaretPosition, const Checkpoint &registers, bool insertionAffectsCaret,
+                        const AutocompletionStack &autocompletionStack, Output &modifiedString,
+                        Output &extractedValue, int &caretPosition, bool &complete,
+                        std::string &tailPlaceholder) const {
+            int modifiedCaretPosition = textCaretPosition + registers.caretShift;
+            uint32_t state = registers.state;
+            Transition next;
+            while (Autocomplete && insertionAffectsCaret) {
+                if (!code.autocomplete(state, next)) {
+                    break;
                 }
-                // 使用 if-else 替代 switch
-                if (optionalValueState->type->getName() == StateTypeName::Numeric) {
-                    return appendPlaceholder(state->child.get(), placeholder + "0");
-                } else if (optionalValueState->type->getName() == StateTypeName::Literal) {
-                    return appendPlaceholder(state->child.get(), placeholder + "a");
-                } else if (optionalValueState->type->getName() == StateTypeName::AlphaNumeric) {
-                    return appendPlaceholder(state->child.get(), placeholder + "-");
-                } else if (optionalValueState->type->getName() == StateTypeName::Custom) {
-                    auto customValueState = dynamic_cast<OptionalValueState *>(state);
-                    auto customStateType = dynamic_cast<OptionalValueState::Custom * >(customValueState->type.get());
-                    return appendPlaceholder(state->child.get(),
-                                             placeholder + customStateType->character);
-                } else {
-                    return placeholder; // 未知类型，返回原始 placeholder
+                state = next.state;
+                if (next.insert != '\0') {
+                    modifiedString += next.insert;
+                }
+                if (next.value != '\0') {
+                    extractedValue += next.value;
+                }
+                if (next.insert == '\0') {
+                    modifiedCaretPosition += 1;
                 }
             }
 
-            if (auto valueState = dynamic_cast<ValueState *>(state)) {
-                if (!state) {
-                    return placeholder; // 如果 state 为 nullptr，直接返回原始 placeholder
-                }
-                // 使用 if-else 替代 switch
-                if (valueState->type->getName() == StateTypeName::Numeric) {
-                    return appendPlaceholder(state->child.get(), placeholder + "0");
-                } else if (valueState->type->getName() == StateTypeName::Literal) {
-                    return appendPlaceholder(state->child.get(), placeholder + "a");
-                } else if (valueState->type->getName() == StateTypeName::AlphaNumeric) {
-                    return appendPlaceholder(state->child.get(), placeholder + "-");
-                } else if (valueState->type->getName() == StateTypeName::Custom) {
-                    auto customValueState = dynamic_cast<OptionalValueState *>(state);
-                    auto customStateType = dynamic_cast<OptionalValueState::Custom * >(customValueState->type.get());
-                    return appendPlaceholder(state->child.get(),
-                                             placeholder + customStateType->character);
+            uint32_t tailState = state;
+            tailPlaceholder.clear();
+            size_t depth = Autoskip ? autocompletionStack.size() : 0;
+            for (; depth > 0; --depth) {
+                const Transition &skip = autocompletionStack.at(depth - 1);
+                if (static_cast<int>(modifiedString.length()) == modifiedCaretPosition) {
+                    if (skip.insert != '\0' && !modifiedString.empty() && skip.insert == modifiedString.back()) {
+                        modifiedString.pop_back();
+                        modifiedCaretPosition -= 1;
+                    }
+                    if (!modifiedString.empty() && !extractedValue.empty() && skip.value == modifiedString.back()) {
+                        extractedValue.pop_back();
+                    }
                 } else {
-                    return placeholder; // 未知类型，返回原始 placeholder
+                    if (skip.insert != '\0') {
+                        modifiedCaretPosition -= 1;
+                    }
                 }
+                tailState = skip.state;
+                tailPlaceholder += skip.insert;
             }
 
-            return placeholder;
-        }
-
-        bool noMandatoryCharactersLeftAfterState(State *state) const {
-            if (dynamic_cast<EOLState *>(state)) {
-                return true;
-            } else if (auto valueState = dynamic_cast<ValueState *>(state)) {
-                return valueState->isElliptical();
-            } else if (dynamic_cast<FixedState *>(state)) {
-                return false;
-            } else {
-                return noMandatoryCharactersLeftAfterState(state->nextState().get());
-            }
+            caretPosition = modifiedCaretPosition;
+            complete = code.suffix(state).complete;
+            code.appendPlaceholder(tailState, tailPlaceholder);
         }
     };
 }
\ No newline at end of file
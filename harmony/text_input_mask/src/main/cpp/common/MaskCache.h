@@ -0,0 +1,192 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "model/Notation.h"
+
+namespace TinpMask {
+
+class Mask;
+
+/**
+ * Process-wide cache of compiled masks shared by ``Mask::MaskFactory`` and ``RTLMask``.
+ *
+ * Entries are keyed by format, custom notations and direction, so the same format compiled with
+ * different notations never aliases. The cache is split into shards guarded by their own
+ * `std::shared_mutex`: lookups only take a shared lock, and JS-thread calls and node events on
+ * the main thread do not race.
+ *
+ * Memory is bounded by a byte budget based on ``Mask::footprint``. When a shard goes over its
+ * share of the budget, its least recently used entries are dropped. Masks still referenced
+ * elsewhere (e.g. by a bound text field) stay alive until released.
+ */
+class MaskCache {
+public:
+    static constexpr size_t ShardCount = 16;
+    static constexpr size_t DefaultBudget = 1 << 20; // 默认 1 MiB
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        size_t bytes;
+        size_t entries;
+    };
+
+    /**
+     * Shared instance. It is never destroyed, so it stays valid during static destruction.
+     */
+    static MaskCache &shared() {
+        static auto *instance = new MaskCache();
+        return *instance;
+    }
+
+    /**
+     * Cache key for a format compiled with `customNotations` in the given direction.
+     *
+     * Variable-length fields are prefixed with their length so that distinct inputs never map to
+     * the same key.
+     */
+    static std::string key(const std::string &format, const std::vector<Notation> &customNotations,
+                           bool rightToLeft) {
+        std::string key;
+        key += rightToLeft ? 'R' : 'L';
+        appendField(key, format);
+        for (const Notation &notation : customNotations) {
+            key += notation.character;
+            key += notation.isOptional ? '?' : '!';
+            key += notation.characterRanges ? '~' : '=';
+            appendField(key, notation.characterSet);
+        }
+        return key;
+    }
+
+    /**
+     * @returns Cached mask for `key`, or `nullptr` on a miss.
+     */
+    std::shared_ptr<Mask> find(const std::string &key) {
+        Shard &shard = shardOf(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        it->second.lastUse.store(shard.clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return it->second.mask;
+    }
+
+    /**
+     * Store a freshly compiled mask that takes about `bytes` of memory.
+     *
+     * Compilation happens outside the lock, so two threads may compile the same key at once; the
+     * first insert wins and both callers get the same instance.
+     *
+     * @returns The cached instance for `key`.
+     */
+    std::shared_ptr<Mask> insert(const std::string &key, std::shared_ptr<Mask> mask, size_t bytes) {
+        Shard &shard = shardOf(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto inserted = shard.entries.try_emplace(key, std::move(mask), bytes);
+        Entry &entry = inserted.first->second;
+        entry.lastUse.store(shard.clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+        if (inserted.second) {
+            shard.bytes += bytes;
+            evict(shard, budget.load(std::memory_order_relaxed) / ShardCount, &entry);
+        }
+        return entry.mask;
+    }
+
+    /**
+     * Drop least recently used entries until the cache holds at most `targetBytes`.
+     *
+     * Meant to be called on memory-pressure signals; `trim()` empties the cache.
+     */
+    void trim(size_t targetBytes = 0) {
+        for (Shard &shard : shards) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            evict(shard, targetBytes / ShardCount, nullptr);
+        }
+    }
+
+    /**
+     * Change the byte budget, evicting immediately if the cache is over it.
+     */
+    void setBudget(size_t bytes) {
+        budget.store(bytes, std::memory_order_relaxed);
+        trim(bytes);
+    }
+
+    Stats stats() const {
+        Stats result{hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed),
+                     evictions.load(std::memory_order_relaxed), 0, 0};
+        for (const Shard &shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            result.bytes += shard.bytes;
+            result.entries += shard.entries.size();
+        }
+        return result;
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<Mask> mask;
+        size_t bytes;
+        std::atomic<uint64_t> lastUse{0}; // 最近一次访问的分片时钟值，读锁下也可更新
+
+        Entry(std::shared_ptr<Mask> mask, size_t bytes) : mask(std::move(mask)), bytes(bytes) {}
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+        std::atomic<uint64_t> clock{0};
+        size_t bytes = 0;
+    };
+
+    std::array<Shard, ShardCount> shards;
+    std::atomic<size_t> budget{DefaultBudget};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+
+    MaskCache() = default;
+
+    static void appendField(std::string &key, const std::string &field) {
+        key += std::to_string(field.size());
+        key += ':';
+        key += field;
+    }
+
+    Shard &shardOf(const std::string &key) { return shards[std::hash<std::string>()(key) % ShardCount]; }
+
+    // 调用方需持有分片写锁；keep 指向的条目（刚插入的掩码）不会被淘汰
+    void evict(Shard &shard, size_t limit, const Entry *keep) {
+        while (shard.bytes > limit) {
+            auto victim = shard.entries.end();
+            for (auto it = shard.entries.begin(); it != shard.entries.end(); ++it) {
+                if (&it->second != keep &&
+                    (victim == shard.entries.end() || it->second.lastUse.load(std::memory_order_relaxed) <
+                                                          victim->second.lastUse.load(std::memory_order_relaxed))) {
+                    victim = it;
+                }
+            }
+            if (victim == shard.entries.end()) {
+                return;
+            }
+            shard.bytes -= victim->second.bytes;
+            shard.entries.erase(victim);
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+} // namespace TinpMask
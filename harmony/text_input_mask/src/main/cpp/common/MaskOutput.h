@@ -0,0 +1,39 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "model/common.h"
+
+namespace TinpMask {
+
+/**
+ * Caller-owned, reusable buffers for ``Mask::applyInto``.
+ *
+ * Keep one per formatting loop (a batch, a text field) and pass it to every call: ``result``
+ * keeps the capacity of its strings and the autocompletion stack is kept too, so once the buffers
+ * have grown to the mask's maximum lengths, formatting does not allocate.
+ */
+class MaskOutput {
+    friend class Mask;
+
+private:
+    std::unique_ptr<AutocompletionStack> autocompletionStack;
+    size_t stackCapacity = 0;
+
+    // 容量足够时复用已有的栈
+    AutocompletionStack &stackFor(size_t capacity) {
+        if (autocompletionStack == nullptr || stackCapacity < capacity) {
+            autocompletionStack = std::make_unique<AutocompletionStack>(capacity);
+            stackCapacity = capacity;
+        }
+        autocompletionStack->truncate(0);
+        return *autocompletionStack;
+    }
+
+public:
+    // 最近一次 applyInto 的结果
+    Result result;
+
+    MaskOutput() : result(CaretString("", 0, nullptr), "", 0, false, "") {}
+};
+
+} // namespace TinpMask
@@ -0,0 +1,74 @@
+#pragma once
+#include <limits>
+#include <memory>
+#include <vector>
+#include "ApplySession.h"
+#include "Mask.h"
+#include "model/AffinityCalculationStrategy.h"
+
+namespace TinpMask {
+
+/**
+ * Primary mask together with its affine masks, evaluated together for affine format selection.
+ *
+ * Every candidate keeps its own ``ApplySession``, so each keystroke only rescans the edited suffix
+ * of the text per candidate. The winner's ``Result`` is the one produced while computing its
+ * affinity; it is not applied a second time, and no ``Mask`` is ever copied.
+ */
+class MaskSet {
+private:
+    std::vector<std::shared_ptr<Mask>> candidates; // 下标 0 为 primary，其后依次为 affine
+    std::vector<ApplySession> sessions;
+    std::vector<int> affinities;
+    size_t winner = 0;
+
+public:
+    MaskSet() = default;
+
+    explicit MaskSet(std::vector<std::shared_ptr<Mask>> masks)
+        : candidates(std::move(masks)), sessions(candidates.size()), affinities(candidates.size(), 0) {}
+
+    bool isEmpty() const { return candidates.empty(); }
+    size_t size() const { return candidates.size(); }
+
+    /**
+     * Compute every candidate's affinity for `text` and apply the winning mask.
+     *
+     * The primary mask wins if its affinity is not lower than the best affine one; otherwise the
+     * first affine mask with the highest affinity wins.
+     *
+     * @returns Result of the winning mask, valid until the next call.
+     */
+    const Result &apply(const CaretString &text, AffinityCalculationStrategy strategy) {
+        if (candidates.size() == 1) {
+            winner = 0;
+            return candidates[0]->apply(text, sessions[0]);
+        }
+        for (size_t index = 0; index < candidates.size(); ++index) {
+            affinities[index] =
+                AffinityCalculator::calculateAffinityOfMask(strategy, *candidates[index], text, sessions[index]);
+        }
+
+        winner = 0;
+        for (size_t index = 1; index < candidates.size(); ++index) {
+            if (affinities[index] > affinities[winner]) {
+                winner = index;
+            }
+        }
+
+        // CAPACITY 只比较长度，不会执行 apply
+        if (strategy == AffinityCalculationStrategy::CAPACITY) {
+            return candidates[winner]->apply(text, sessions[winner]);
+        }
+        return sessions[winner].lastResult();
+    }
+
+    // 最近一次 apply 选中的掩码
+    const std::shared_ptr<Mask> &winnerMask() const { return candidates[winner]; }
+    size_t winnerIndex() const { return winner; }
+
+    // 最近一次 apply 中各候选掩码的亲和度，顺序与构造参数一致；仅有 primary 时不计算
+    const std::vector<int> &candidateAffinities() const { return affinities; }
+};
+
+} // namespace TinpMask
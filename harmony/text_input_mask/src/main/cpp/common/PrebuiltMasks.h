@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <string_view>
+#include "StaticProgram.h"
+
+namespace TinpMask {
+
+/**
+ * Registry of formats compiled into the library binary.
+ *
+ * ``Mask::MaskFactory::getOrCreate`` serves these formats from their ``StaticProgram`` when no
+ * custom notations are given, so they never go through ``FormatSanitizer`` or ``Compiler`` at
+ * runtime. To prebuild another literal format, add it below; an invalid format fails the build.
+ */
+class PrebuiltMasks {
+public:
+    struct Entry {
+        std::string_view format;
+        ProgramView program;
+    };
+
+    static constexpr auto PhoneRu = compileStatic("+7 ([000]) [000]-[00]-[00]");
+    static constexpr auto PhoneUs = compileStatic("+1 ([000]) [000] [00] [00]");
+    static constexpr auto CardNumber = compileStatic("[0000] [0000] [0000] [0000]");
+    static constexpr auto Date = compileStatic("[00]{.}[00]{.}[0000]");
+
+    static constexpr std::array<Entry, 4> Entries = {{
+        {PhoneRu.format, PhoneRu.view()},
+        {PhoneUs.format, PhoneUs.view()},
+        {CardNumber.format, CardNumber.view()},
+        {Date.format, Date.view()},
+    }};
+
+    static constexpr size_t Count = Entries.size();
+
+    /**
+     * @returns Index of `format` in ``Entries``, or `-1` if it is not prebuilt.
+     */
+    static int indexOf(std::string_view format) {
+        for (size_t i = 0; i < Count; ++i) {
+            if (Entries[i].format == format) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+};
+
+} // namespace TinpMask
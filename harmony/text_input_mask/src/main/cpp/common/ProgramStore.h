@@ -0,0 +1,344 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include "model/CharacterClass.h"
+#include "model/Instruction.h"
+#include "model/Program.h"
+
+namespace TinpMask {
+
+/**
+ * Persistent store of compiled programs, shared across process starts.
+ *
+ * Masks compiled at runtime are recorded under their ``MaskCache`` key and can be written to a
+ * single cache file. On the next start the file is mapped read-only with `mmap`. Its tables are
+ * used in place through ``ProgramView``, so those formats are neither parsed nor compiled again.
+ *
+ * The file is position-independent: every table is addressed by its offset from the start of
+ * the file. A header with a magic number, ``Version``, a fingerprint of the record layouts and
+ * a checksum guards against stale or foreign files. A file that fails any check is ignored,
+ * and the next ``write`` replaces it.
+ *
+ * The mapping is never unmapped, so views handed out stay valid for the life of the process.
+ */
+class ProgramStore {
+public:
+    // 指令语义或文件布局变化时递增
+    static constexpr uint32_t Version = 4;
+    // 记录条目的上限，防止动态格式无限增长
+    static constexpr size_t MaxEntries = 4096;
+
+    /**
+     * Shared instance. It is never destroyed, so it stays valid during static destruction.
+     */
+    static ProgramStore &shared() {
+        static auto *instance = new ProgramStore();
+        return *instance;
+    }
+
+    // 独立的存储，仅供工具与测试使用；其映射同样不会解除
+    ProgramStore() = default;
+
+    /**
+     * Map the cache file at `path`, unless a file is already mapped.
+     *
+     * @returns `true` if a valid cache file is mapped.
+     */
+    bool open(const std::string &path) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (mapping != nullptr) {
+            return true;
+        }
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat status;
+        if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(FileHeader)) {
+            close(fd);
+            return false;
+        }
+        const size_t size = static_cast<size_t>(status.st_size);
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        if (!load(static_cast<const uint8_t *>(data), size)) {
+            stored.clear();
+            munmap(data, size);
+            return false;
+        }
+        mapping = data;
+        return true;
+    }
+
+    /**
+     * Look up a stored program by its ``MaskCache`` key.
+     *
+     * @returns `true` and fills `program` if the mapped file contains `key`.
+     */
+    bool find(const std::string &key, ProgramView &program) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = stored.find(key);
+        if (it == stored.end()) {
+            return false;
+        }
+        program = it->second;
+        return true;
+    }
+
+    /**
+     * Remember a program compiled in this session so that the next ``write`` includes it.
+     */
+    void record(const std::string &key, const Program &program) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (stored.size() + pending.size() >= MaxEntries || stored.count(key) != 0) {
+            return;
+        }
+        if (pending.try_emplace(key, program).second) {
+            dirty = true;
+        }
+    }
+
+    /**
+     * Write the mapped and the recorded programs to `path`.
+     *
+     * The file is written next to `path` and renamed over it, so readers never observe a partial
+     * file and the current mapping is unaffected. Does nothing if no program was recorded since
+     * the last write.
+     *
+     * @returns `false` if the file could not be written.
+     */
+    bool write(const std::string &path) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (!dirty) {
+            return true;
+        }
+        std::string buffer = serialize();
+        std::string temporaryPath = path + ".tmp";
+        int fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            return false;
+        }
+        size_t written = 0;
+        while (written < buffer.size()) {
+            ssize_t result = ::write(fd, buffer.data() + written, buffer.size() - written);
+            if (result <= 0) {
+                close(fd);
+                unlink(temporaryPath.c_str());
+                return false;
+            }
+            written += static_cast<size_t>(result);
+        }
+        if (fsync(fd) != 0 || close(fd) != 0 || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+            unlink(temporaryPath.c_str());
+            return false;
+        }
+        dirty = false;
+        return true;
+    }
+
+private:
+    static_assert(std::is_trivially_copyable<Instruction>::value, "Instruction is stored as raw bytes");
+    static_assert(std::is_trivially_copyable<CharacterClass>::value, "CharacterClass is stored as raw bytes");
+    static_assert(std::is_trivially_copyable<Suffix>::value, "Suffix is stored as raw bytes");
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t layout; // 记录结构体大小与字节序，不同构建产物的文件互不通用
+        uint32_t entryCount;
+        uint64_t fileSize;
+        uint64_t checksum; // 文件头之后所有字节的 FNV-1a
+    };
+
+    // 各字段均为相对文件起始位置的偏移
+    struct EntryRecord {
+        uint32_t keyOffset;
+        uint32_t keyLength;
+        uint32_t instructionsOffset;
+        uint32_t instructionCount;
+        uint32_t characterClassesOffset;
+        uint32_t characterClassCount;
+        uint32_t placeholdersOffset;
+        uint32_t suffixesOffset;
+        uint32_t autocompletableCount;
+    };
+
+    static constexpr char Magic[4] = {'T', 'I', 'M', 'P'};
+    static constexpr size_t Alignment = 8;
+
+    mutable std::shared_mutex mutex;
+    void *mapping = nullptr;
+    std::unordered_map<std::string_view, ProgramView> stored; // 键与表都指向映射区
+    std::unordered_map<std::string, Program> pending;         // 本次运行新编译的程序
+    bool dirty = false;
+
+    static uint32_t layoutTag() {
+        const uint32_t probe = 1;
+        uint8_t littleEndian = 0;
+        std::memcpy(&littleEndian, &probe, 1);
+        return static_cast<uint32_t>(sizeof(Instruction)) | static_cast<uint32_t>(sizeof(Suffix)) << 8 |
+               static_cast<uint32_t>(sizeof(CharacterClass)) << 16 | static_cast<uint32_t>(littleEndian) << 24;
+    }
+
+    static uint64_t checksumOf(const uint8_t *data, size_t length) {
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < length; ++i) {
+            hash = (hash ^ data[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static bool inBounds(size_t size, uint64_t offset, uint64_t length, size_t alignment) {
+        return offset % alignment == 0 && offset <= size && length <= size - offset;
+    }
+
+    // 校验并索引映射的文件；任何一项不符都放弃整个文件
+    bool load(const uint8_t *data, size_t size) {
+        FileHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version ||
+            header.layout != layoutTag() || header.fileSize != size ||
+            header.checksum != checksumOf(data + sizeof(header), size - sizeof(header)) ||
+            !inBounds(size, sizeof(header), uint64_t(header.entryCount) * sizeof(EntryRecord), 1)) {
+            return false;
+        }
+        const auto *records = reinterpret_cast<const EntryRecord *>(data + sizeof(header));
+        for (uint32_t i = 0; i < header.entryCount; ++i) {
+            const EntryRecord &record = records[i];
+            if (!isValid(data, size, record)) {
+                return false;
+            }
+            ProgramView view;
+            view.instructions = reinterpret_cast<const Instruction *>(data + record.instructionsOffset);
+            view.characterClasses = reinterpret_cast<const CharacterClass *>(data + record.characterClassesOffset);
+            view.placeholders = reinterpret_cast<const char *>(data + record.placeholdersOffset);
+            view.suffixes = reinterpret_cast<const Suffix *>(data + record.suffixesOffset);
+            view.instructionCount = record.instructionCount;
+            view.autocompletableCount = record.autocompletableCount;
+            stored.emplace(std::string_view(reinterpret_cast<const char *>(data + record.keyOffset), record.keyLength),
+                           view);
+        }
+        return true;
+    }
+
+    // 解释器依赖的不变量：以 EOL 结尾、字符类下标有效、占位符区间合法、自动完成栈容量足够
+    static bool isValid(const uint8_t *data, size_t size, const EntryRecord &record) {
+        const uint64_t count = record.instructionCount;
+        if (count == 0 || !inBounds(size, record.keyOffset, record.keyLength, 1) ||
+            !inBounds(size, record.instructionsOffset, count * sizeof(Instruction), alignof(Instruction)) ||
+            !inBounds(size, record.characterClassesOffset,
+                      uint64_t(record.characterClassCount) * sizeof(CharacterClass), alignof(CharacterClass)) ||
+            !inBounds(size, record.placeholdersOffset, count - 1, 1) ||
+            !inBounds(size, record.suffixesOffset, count * sizeof(Suffix), alignof(Suffix))) {
+            return false;
+        }
+        const auto *instructions = reinterpret_cast<const Instruction *>(data + record.instructionsOffset);
+        const auto *suffixes = reinterpret_cast<const Suffix *>(data + record.suffixesOffset);
+        const auto *placeholders = reinterpret_cast<const char *>(data + record.placeholdersOffset);
+        uint32_t autocompletable = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            const Instruction &instruction = instructions[i];
+            if ((i + 1 == count) != (instruction.kind == InstructionKind::EOL) ||
+                suffixes[i].placeholderEnd < i || suffixes[i].placeholderEnd > count - 1) {
+                return false;
+            }
+            // 字面连续段按占位符整段比较，长度与字符都必须与指令一致；字面指令之后必有 EOL，i + 1 有效
+            const bool literal = instruction.kind == InstructionKind::Fixed || instruction.kind == InstructionKind::Free;
+            if (suffixes[i].literalRunLength != (literal ? literalRunLength(instructions, i, suffixes[i + 1]) : 0) ||
+                (literal && placeholders[i] != instruction.ownCharacter)) {
+                return false;
+            }
+            switch (instruction.kind) {
+            case InstructionKind::Fixed:
+            case InstructionKind::Free:
+                autocompletable += 1;
+                break;
+            case InstructionKind::Value:
+            case InstructionKind::OptionalValue:
+                if (instruction.characterClass >= record.characterClassCount) {
+                    return false;
+                }
+                break;
+            case InstructionKind::EOL:
+                break;
+            default:
+                return false;
+            }
+        }
+        return autocompletable == record.autocompletableCount;
+    }
+
+    static uint32_t append(std::string &buffer, const void *data, size_t length) {
+        buffer.resize((buffer.size() + Alignment - 1) / Alignment * Alignment, '\0');
+        const auto offset = static_cast<uint32_t>(buffer.size());
+        if (length > 0) {
+            buffer.append(static_cast<const char *>(data), length);
+        }
+        return offset;
+    }
+
+    static EntryRecord appendProgram(std::string &buffer, std::string_view key, const ProgramView &program) {
+        EntryRecord record{};
+        record.keyOffset = append(buffer, key.data(), key.size());
+        record.keyLength = static_cast<uint32_t>(key.size());
+        record.instructionCount = program.instructionCount;
+        record.instructionsOffset =
+            append(buffer, program.instructions, program.instructionCount * sizeof(Instruction));
+        uint32_t characterClassCount = 0;
+        for (uint32_t i = 0; i < program.instructionCount; ++i) {
+            const Instruction &instruction = program.instructions[i];
+            if (instruction.kind == InstructionKind::Value || instruction.kind == InstructionKind::OptionalValue) {
+                characterClassCount = std::max<uint32_t>(characterClassCount, instruction.characterClass + 1u);
+            }
+        }
+        record.characterClassCount = characterClassCount;
+        record.characterClassesOffset =
+            append(buffer, program.characterClasses, characterClassCount * sizeof(CharacterClass));
+        record.placeholdersOffset = append(buffer, program.placeholders, program.instructionCount - 1);
+        record.suffixesOffset = append(buffer, program.suffixes, program.instructionCount * sizeof(Suffix));
+        record.autocompletableCount = program.autocompletableCount;
+        return record;
+    }
+
+    std::string serialize() const {
+        const size_t entryCount = stored.size() + pending.size();
+        std::string buffer(sizeof(FileHeader) + entryCount * sizeof(EntryRecord), '\0');
+        std::vector<EntryRecord> records;
+        records.reserve(entryCount);
+        for (const auto &entry : stored) {
+            records.push_back(appendProgram(buffer, entry.first, entry.second));
+        }
+        for (const auto &entry : pending) {
+            records.push_back(appendProgram(buffer, entry.first, entry.second.view()));
+        }
+        std::memcpy(&buffer[sizeof(FileHeader)], records.data(), records.size() * sizeof(EntryRecord));
+
+        FileHeader header{};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.layout = layoutTag();
+        header.entryCount = static_cast<uint32_t>(entryCount);
+        header.fileSize = buffer.size();
+        header.checksum = checksumOf(reinterpret_cast<const uint8_t *>(buffer.data()) + sizeof(FileHeader),
+                                     buffer.size() - sizeof(FileHeader));
+        std::memcpy(&buffer[0], &header, sizeof(header));
+        return buffer;
+    }
+};
+
+} // namespace TinpMask
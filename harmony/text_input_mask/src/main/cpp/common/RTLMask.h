@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include "common/Mask.h"
 #include "common/model/CaretString.h"
 #include "common/model/Notation.h"
@@ -7,31 +8,42 @@ namespace TinpMask {
 class RTLMask : public Mask   {
     
 public:
-     static std::unordered_map<std::string, std::shared_ptr<RTLMask>> cache ;
     RTLMask(const std::string& format, const std::vector<Notation>& customNotations)
         : Mask(reversedFormat(format), customNotations) {}
 
     static std::shared_ptr<RTLMask> getOrCreate(const std::string& format, const std::vector<Notation>& customNotations) {
-        std::string reversed = reversedFormat(format);
-        auto it = cache.find(reversed);
-        if (it != cache.end()) {
-            return it->second; // Return cached instance
+        std::string key = MaskCache::key(format, customNotations, true);
+        // 方向是键的一部分，RTL 键下只会存放 RTLMask
+        if (auto cached = MaskCache::shared().find(key)) {
+            return std::static_pointer_cast<RTLMask>(cached);
         }
 
         // Create new instance and cache it
-        auto newMask = std::make_shared<RTLMask>(format, customNotations);
-        cache[reversed] = newMask;
-        return newMask;
+        std::shared_ptr<RTLMask> newMask;
+        ProgramView stored;
+        if (ProgramStore::shared().find(key, stored)) {
+            newMask = std::shared_ptr<RTLMask>(new RTLMask(format, stored));
+        } else {
+            newMask = std::make_shared<RTLMask>(format, customNotations);
+            ProgramStore::shared().record(key, newMask->program);
+        }
+        size_t bytes = newMask->footprint();
+        return std::static_pointer_cast<RTLMask>(MaskCache::shared().insert(key, std::move(newMask), bytes));
     }
 
-    Result apply(const CaretString& text) override {
-        return Mask::apply(text.reversed()).reversed(); // Assuming the Result class has a reversed method
+    using Mask::apply;
+
+    // 从末尾向前扫描输入，结果直接按阅读顺序生成
+    const Result &applyInto(const CaretString &text, MaskOutput &output) override {
+        return applyBackward(text, output);
     }
-    
 
-private:
-   
+    const Result &apply(const CaretString &text, ApplySession &session) override {
+        return applyBackward(text, session);
+    }
+    
 
+    // 逐字符反转格式并交换括号方向；RTLMask 按这个格式编译
     static std::string reversedFormat(const std::string& format) {
         std::string reversed = std::string(format.rbegin(), format.rend());
         
@@ -57,6 +69,15 @@ private:
             pos += 1;
         }
 
+        // 多字节的省略号在逐字节反转后需要恢复原有字节顺序
+        std::string reversedEllipsis(EllipsisSymbol, EllipsisSymbolLength);
+        std::reverse(reversedEllipsis.begin(), reversedEllipsis.end());
+        pos = 0;
+        while ((pos = reversed.find(reversedEllipsis, pos)) != std::string::npos) {
+            reversed.replace(pos, EllipsisSymbolLength, EllipsisSymbol);
+            pos += EllipsisSymbolLength;
+        }
+
         // Map logic for brackets
         for (char& ch : reversed) {
             switch (ch) {
@@ -69,5 +90,9 @@ private:
         }
         return reversed;
     }
+
+private:
+    // 程序取自 ProgramStore，已按反转后的格式编译
+    RTLMask(const std::string& format, const ProgramView& code) : Mask(format, code) {}
 };
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "Compiler.h"
+#include "FormatError.h"
+#include "FormatSanitizer.h"
+#include "model/CharacterClass.h"
+#include "model/Instruction.h"
+#include "model/Program.h"
+
+namespace TinpMask {
+
+/**
+ * Fixed-capacity character buffer usable in constant expressions.
+ *
+ * Output buffer of ``FormatSanitizer::sanitizeInto`` when a format is sanitized at compile time.
+ */
+template <size_t Capacity>
+class StaticString {
+private:
+    std::array<char, Capacity> characters{};
+    size_t length = 0;
+
+public:
+    constexpr size_t size() const { return length; }
+
+    constexpr void push_back(char ch) {
+        if (length == Capacity) {
+            throw FormatError("Static format buffer overflow");
+        }
+        characters[length++] = ch;
+    }
+
+    // 只用于截断
+    constexpr void resize(size_t size) { length = size; }
+
+    constexpr char &operator[](size_t index) { return characters[index]; }
+    constexpr char operator[](size_t index) const { return characters[index]; }
+
+    constexpr std::string_view view() const { return std::string_view(characters.data(), length); }
+};
+
+/**
+ * Compiled mask whose tables live in fixed-size arrays instead of heap vectors.
+ *
+ * Produced by ``compileStatic`` during compilation, so a format literal becomes read-only data
+ * of the library binary: no sanitizing, compiling or allocation at runtime. Only built-in
+ * notations are supported, and the result is identical to ``Compiler::assemble`` for the same
+ * format. ``Mask`` interprets it through ``view``.
+ *
+ * `Capacity` bounds the instruction count; a format of `n` bytes needs at most `n + 1`.
+ */
+template <size_t Capacity>
+class StaticProgram {
+public:
+    // 内置记号最多用到数字、字母、字母数字三种字符类
+    static constexpr size_t CharacterClassCapacity = 3;
+
+    std::string_view format;
+    std::array<Instruction, Capacity> instructions{};
+    std::array<CharacterClass, CharacterClassCapacity> characterClasses{};
+    std::array<char, Capacity> placeholders{};
+    std::array<Suffix, Capacity> suffixes{};
+    uint32_t instructionCount = 0;
+    uint32_t characterClassCount = 0;
+    uint32_t autocompletableCount = 0;
+
+    /**
+     * Sanitize and compile `formatString` into a new program.
+     *
+     * @throws FormatError if the format is invalid, uses custom notations or does not fit into
+     * `Capacity` instructions. In a constant expression this is a compilation error.
+     */
+    static constexpr StaticProgram compile(std::string_view formatString) {
+        // 拆分 [] 块时每个字符最多多出 "][" 两个字符
+        StaticString<3 * Capacity> sanitized;
+        FormatSanitizer::sanitizeInto(formatString, sanitized);
+
+        StaticProgram program;
+        program.format = formatString;
+        char lastCharacter = '\0';
+        const bool elliptical = Compiler::scanFormat(
+            sanitized.view(), false, false, lastCharacter,
+            [&program](Compiler::TokenKind kind, char ch) { program.add(kind, ch); });
+        if (elliptical) {
+            program.addEllipsis(lastCharacter);
+        }
+        program.push({InstructionKind::EOL, '\0', 0, 0});
+        indexSuffixes(program.instructions.data(), program.instructionCount, program.placeholders.data(),
+                      program.suffixes.data());
+        return program;
+    }
+
+    constexpr ProgramView view() const {
+        return {instructions.data(), characterClasses.data(), placeholders.data(),
+                suffixes.data(),     instructionCount,        autocompletableCount};
+    }
+
+private:
+    constexpr void push(const Instruction &instruction) {
+        if (instructionCount == Capacity) {
+            throw FormatError("Static program overflow");
+        }
+        instructions[instructionCount++] = instruction;
+    }
+
+    constexpr void add(Compiler::TokenKind kind, char ch) {
+        switch (kind) {
+        case Compiler::TokenKind::Fixed:
+            push({InstructionKind::Fixed, ch, 0, 0});
+            autocompletableCount += 1;
+            break;
+        case Compiler::TokenKind::Free:
+            push({InstructionKind::Free, ch, 0, 0});
+            autocompletableCount += 1;
+            break;
+        case Compiler::TokenKind::Value:
+            push({InstructionKind::Value, placeholderOf(ch), characterClassOf(ch), 0});
+            break;
+        case Compiler::TokenKind::OptionalValue:
+            push({InstructionKind::OptionalValue, placeholderOf(ch), characterClassOf(ch), 0});
+            break;
+        case Compiler::TokenKind::Custom:
+            throw FormatError("Custom notations are not supported in static programs");
+        }
+    }
+
+    // 省略号继承前一个字符的类型，与 Compiler::determineInheritedType 一致
+    constexpr void addEllipsis(char lastCharacter) {
+        if (lastCharacter == '[') {
+            lastCharacter = '_';
+        }
+        if (lastCharacter != '0' && lastCharacter != '9' && lastCharacter != 'A' && lastCharacter != 'a' &&
+            lastCharacter != '_' && lastCharacter != '-') {
+            throw FormatError("Custom notations are not supported in static programs");
+        }
+        push({InstructionKind::Value, placeholderOf(lastCharacter), characterClassOf(lastCharacter),
+              Instruction::Elliptical});
+    }
+
+    static constexpr char placeholderOf(char notation) {
+        switch (notation) {
+        case '0':
+        case '9':
+            return '0';
+        case 'A':
+        case 'a':
+            return 'a';
+        default:
+            return '-';
+        }
+    }
+
+    // 与 Compiler 相同：字符类按首次出现的顺序去重存放
+    constexpr uint8_t characterClassOf(char notation) {
+        CharacterClass characterClass;
+        switch (notation) {
+        case '0':
+        case '9':
+            characterClass = CharacterClass::numeric();
+            break;
+        case 'A':
+        case 'a':
+            characterClass = CharacterClass::literal();
+            break;
+        default:
+            characterClass = CharacterClass::alphaNumeric();
+            break;
+        }
+        for (uint32_t i = 0; i < characterClassCount; ++i) {
+            if (characterClasses[i] == characterClass) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        characterClasses[characterClassCount] = characterClass;
+        return static_cast<uint8_t>(characterClassCount++);
+    }
+};
+
+/**
+ * Compile a format literal into a ``StaticProgram``.
+ *
+ * Meant for `constexpr` variables, e.g.
+ * `static constexpr auto card = compileStatic("[0000] [0000] [0000] [0000]");`
+ */
+template <size_t N>
+constexpr StaticProgram<N> compileStatic(const char (&format)[N]) {
+    return StaticProgram<N>::compile(std::string_view(format, N - 1));
+}
+
+} // namespace TinpMask
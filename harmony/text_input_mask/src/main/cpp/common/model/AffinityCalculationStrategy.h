@@ -18,17 +18,14 @@ public:
             return mask.apply(text).affinity;
 
         case AffinityCalculationStrategy::PREFIX:
-            return prefixIntersection(mask.apply(text).formattedText.string, text.string).length();
+            return prefixLength(mask.apply(text).formattedText.string, text.string);
 
         case AffinityCalculationStrategy::CAPACITY:
-            return text.string.length() > mask.totalTextLength() ? std::numeric_limits<int>::min()
-                                                                 : text.string.length() - mask.totalTextLength();
+            return capacityAffinity(text.string.length(), mask.totalTextLength());
 
         case AffinityCalculationStrategy::EXTRACTED_VALUE_CAPACITY: {
             const auto &extractedValue = mask.apply(text).extractedValue;
-            return extractedValue.length() > mask.totalValueLength()
-                       ? std::numeric_limits<int>::min()
-                       : extractedValue.length() - mask.totalValueLength();
+            return capacityAffinity(extractedValue.length(), mask.totalValueLength());
         }
 
         default:
@@ -36,18 +33,43 @@ public:
         }
     }
 
+    /**
+     * Same as above, but applies the mask incrementally through `session`, so that repeated calls
+     * for the same text field only rescan the edited part of the text.
+     */
+    static int calculateAffinityOfMask(AffinityCalculationStrategy strategy, Mask &mask, const CaretString &text,
+                                       ApplySession &session) {
+        switch (strategy) {
+        case AffinityCalculationStrategy::WHOLE_STRING:
+            return mask.apply(text, session).affinity;
+
+        case AffinityCalculationStrategy::PREFIX:
+            return prefixLength(mask.apply(text, session).formattedText.string, text.string);
+
+        case AffinityCalculationStrategy::EXTRACTED_VALUE_CAPACITY: {
+            const auto &extractedValue = mask.apply(text, session).extractedValue;
+            return capacityAffinity(extractedValue.length(), mask.totalValueLength());
+        }
+
+        default:
+            return calculateAffinityOfMask(strategy, mask, text);
+        }
+    }
+
 private:
-    // Helper function to find prefix intersection
-    static std::string prefixIntersection(const std::string &str1, const std::string &str2) {
+    // 长度超出容量时为 Int.MIN，否则为长度与容量之差（不大于 0）
+    static int capacityAffinity(size_t length, int capacity) {
+        const int used = static_cast<int>(length);
+        return used > capacity ? std::numeric_limits<int>::min() : used - capacity;
+    }
+
+    // 两个字符串公共前缀的长度
+    static int prefixLength(const std::string &str1, const std::string &str2) {
         size_t endIndex = 0;
-        while (endIndex < str1.length() && endIndex < str2.length()) {
-            if (str1[endIndex] == str2[endIndex]) {
-                endIndex += 1;
-            } else {
-                return str1.substr(0, endIndex);
-            }
+        while (endIndex < str1.length() && endIndex < str2.length() && str1[endIndex] == str2[endIndex]) {
+            endIndex += 1;
         }
-        return str1.substr(0, endIndex);
+        return static_cast<int>(endIndex);
     }
 };
 } // namespace TinpMask
\ No newline at end of file
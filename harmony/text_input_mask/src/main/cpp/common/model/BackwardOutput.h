@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+namespace TinpMask {
+
+/**
+ * Output string of the right-to-left ``Mask`` scan, filled from its end towards its start.
+ *
+ * The right-to-left scan produces the last character of the result first; writing backwards into
+ * a pre-sized buffer leaves the result in reading order, so nothing has to be reversed. Offers
+ * the subset of `std::string` used by ``Mask``, mirrored: `back` is the character written last,
+ * i.e. the first one of the result.
+ */
+class BackwardOutput {
+private:
+    std::string &buffer;
+    size_t begin; // 已写入内容的起点；[begin, size) 为结果
+
+public:
+    // 复用 buffer 的容量，capacity 为预计的最大长度
+    BackwardOutput(std::string &buffer, size_t capacity) : buffer(buffer), begin(capacity) {
+        buffer.resize(capacity);
+    }
+
+    BackwardOutput &operator+=(char ch) {
+        if (begin == 0) {
+            grow();
+        }
+        buffer[--begin] = ch;
+        return *this;
+    }
+
+    size_t length() const { return buffer.size() - begin; }
+    bool empty() const { return begin == buffer.size(); }
+    char back() const { return buffer[begin]; }
+    void pop_back() { begin += 1; }
+
+    // 把结果移到 buffer 开头，之后 buffer 即为最终字符串
+    void commit() {
+        buffer.erase(0, begin);
+        begin = 0;
+    }
+
+private:
+    // 预估长度不足时在前面补出空间，正常情况下不会发生
+    void grow() {
+        const size_t extra = std::max<size_t>(buffer.size(), 16);
+        buffer.insert(0, extra, '\0');
+        begin = extra;
+    }
+};
+
+} // namespace TinpMask
@@ -1,6 +1,8 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <utility>
 
 namespace TinpMask {
 
@@ -9,18 +11,30 @@ class CaretString {
 public:
     class CaretGravity {
     public:
+        // 光标规则的种类，供 Mask 在扫描前一次性选定特化版本
+        enum class Kind : uint8_t { Custom, Forward, Backward };
+
+        CaretGravity() = default;
         virtual ~CaretGravity() = default; // 虚析构函数
 
+        Kind kind() const { return gravityKind; }
+
         // 获取自动完成值
         virtual bool autocomplete() const { return false; }
         // 获取自动跳过值
         virtual bool autoskip() const { return false; }
+
+    protected:
+        explicit CaretGravity(Kind kind) : gravityKind(kind) {}
+
+    private:
+        Kind gravityKind = Kind::Custom;
     };
 
     // 向前的光标重力
     class Forward : public CaretGravity {
     public:
-        Forward(bool autoCompleteValue) : autocompleteValue(autoCompleteValue) {}
+        Forward(bool autoCompleteValue) : CaretGravity(Kind::Forward), autocompleteValue(autoCompleteValue) {}
 
         bool autocomplete() const override { return autocompleteValue; }
 
@@ -31,7 +45,7 @@ public:
     // 向后的光标重力
     class Backward : public CaretGravity {
     public:
-        Backward(bool autoSkipValue) : autoskipValue(autoSkipValue) {}
+        Backward(bool autoSkipValue) : CaretGravity(Kind::Backward), autoskipValue(autoSkipValue) {}
 
         bool autoskip() const override { return autoskipValue; }
 
@@ -41,8 +55,8 @@ public:
 
 public:
     // 构造函数
-    CaretString(const std::string &str, int caretPos, std::shared_ptr<CaretGravity> caretGrav)
-        : string(str), caretPosition(caretPos), caretGravity(caretGrav) {}
+    CaretString(std::string str, int caretPos, std::shared_ptr<CaretGravity> caretGrav)
+        : string(std::move(str)), caretPosition(caretPos), caretGravity(std::move(caretGrav)) {}
 
     // 反转字符串并返回新的 CaretString 对象
     CaretString reversed() const {
@@ -50,7 +64,7 @@ public:
         std::string reversedStr(string.rbegin(), string.rend());
         // 计算新的 caretPosition
         int newCaretPos = string.length() - caretPosition;
-        return CaretString(reversedStr, newCaretPos, caretGravity);
+        return CaretString(std::move(reversedStr), newCaretPos, caretGravity);
     }
 
     // 获取字符串
@@ -1,52 +1,79 @@
 #pragma once
+#include <algorithm>
+#include <cstring>
 #include <string>
-#include <memory>
-#include <string>
-#include <memory>
 #include "CaretString.h"
 
 namespace TinpMask {
 
+/**
+ * Left-to-right view over a ``CaretString``, used by ``Mask::apply`` on the stack.
+ *
+ * The caret rule of the gravity is a template parameter, so the per-character checks are plain
+ * comparisons: no virtual calls and no RTTI. ``Mask`` picks the instantiation once per call from
+ * ``CaretString::CaretGravity::kind``. The iterator only points into the string; the caller keeps
+ * the ``CaretString`` alive while iterating.
+ */
+template <CaretString::CaretGravity::Kind Gravity>
 class CaretStringIterator {
 protected:
-    CaretString caretString; // 关联的 CaretString 对象
-    int currentIndex;        // 当前索引
+    const char *characters; // 不拷贝字符串
+    int length;
+    int caretPosition;
+    int currentIndex; // 当前索引
 
 public:
-    // 构造函数
-    CaretStringIterator(const CaretString &caretStr, int index = 0) : caretString(caretStr), currentIndex(index) {}
+    // 按字符串顺序读取，Mask 可以整段比较字面字符
+    static constexpr bool ReadsForward = true;
 
-    // 插入是否影响光标位置
-    virtual bool insertionAffectsCaret() {
+    explicit CaretStringIterator(const CaretString &caretString, int index = 0)
+        : characters(caretString.string.data()), length(static_cast<int>(caretString.string.length())),
+          caretPosition(caretString.caretPosition), currentIndex(index) {}
 
-        if (dynamic_cast<CaretString::Backward *>(caretString.caretGravity.get())) {
-            return currentIndex < caretString.getCaretPosition();
-        } else if (dynamic_cast<CaretString::Forward *>(caretString.caretGravity.get())) {
-            return currentIndex <= caretString.getCaretPosition() ||
-                   (currentIndex == 0 && caretString.getCaretPosition() == 0);
+    // 插入是否影响光标位置
+    bool insertionAffectsCaret() const {
+        if constexpr (Gravity == CaretString::CaretGravity::Kind::Backward) {
+            return currentIndex < caretPosition;
+        } else if constexpr (Gravity == CaretString::CaretGravity::Kind::Forward) {
+            return currentIndex <= caretPosition;
+        } else {
+            return false;
         }
-        return false;
     }
 
     // 删除是否影响光标位置
-    virtual bool deletionAffectsCaret() { return currentIndex < caretString.getCaretPosition(); }
+    bool deletionAffectsCaret() const { return currentIndex < caretPosition; }
 
     /**
      * 遍历 CaretString.string
      * @postcondition: 迭代器位置移到下一个符号。
-     * @returns 当前符号。如果迭代器到达字符串末尾，返回 nullptr。
+     * @returns 当前符号。如果迭代器到达字符串末尾，返回 '\0'。
      */
-    virtual char next() {
-        if (currentIndex >= caretString.getString().length()) {
-            return '\0'; // 返回空指针表示到达字符串末尾
+    char next() {
+        if (currentIndex >= length) {
+            return '\0';
         }
+        return characters[currentIndex++];
+    }
 
-//         char *charPtr = new char;                         // 创建一个字符指针
-        auto charPtr = caretString.getString()[currentIndex]; // 获取当前字符
-        currentIndex += 1;                                // 移动到下一个索引
-        return charPtr;                                   // 返回当前字符
+    /**
+     * Length of the common prefix of the unread characters and `literal`, at most `count`.
+     *
+     * Does not move the iterator.
+     */
+    size_t matchLength(const char *literal, size_t count) const {
+        const char *unread = characters + currentIndex;
+        const size_t available = std::min(count, static_cast<size_t>(length - currentIndex));
+        // 常见情况是整段相同，一次 memcmp 即可
+        if (std::memcmp(unread, literal, available) == 0) {
+            return available;
+        }
+        size_t matched = 0;
+        while (unread[matched] == literal[matched]) {
+            matched += 1;
+        }
+        return matched;
     }
 };
 
-
 } // namespace TinpMask
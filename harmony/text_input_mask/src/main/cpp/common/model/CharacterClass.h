@@ -0,0 +1,110 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace TinpMask {
+
+// 自定义字符集的写法：逐字符，或允许 a-z 形式的区间
+enum class SetSyntax : uint8_t { Literal, Ranges };
+
+/**
+ * Set of characters accepted by a value state, stored as a 256-bit bitmap.
+ *
+ * Classes are resolved once at compile time, so accepting a character is a single bit test that
+ * does not depend on the C locale.
+ */
+class CharacterClass {
+private:
+    std::array<uint64_t, 4> bits{};
+
+public:
+    constexpr CharacterClass() = default;
+
+    constexpr bool contains(char character) const {
+        const auto code = static_cast<unsigned char>(character);
+        return ((bits[code >> 6] >> (code & 63)) & 1) != 0;
+    }
+
+    constexpr CharacterClass &add(char character) {
+        const auto code = static_cast<unsigned char>(character);
+        bits[code >> 6] |= uint64_t(1) << (code & 63);
+        return *this;
+    }
+
+    constexpr CharacterClass &addRange(char from, char to) {
+        for (unsigned code = static_cast<unsigned char>(from); code <= static_cast<unsigned char>(to); ++code) {
+            add(static_cast<char>(code));
+        }
+        return *this;
+    }
+
+    constexpr CharacterClass &add(const CharacterClass &other) {
+        for (size_t i = 0; i < bits.size(); ++i) {
+            bits[i] |= other.bits[i];
+        }
+        return *this;
+    }
+
+    constexpr const std::array<uint64_t, 4> &words() const { return bits; }
+
+    constexpr bool operator==(const CharacterClass &other) const {
+        return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2] &&
+               bits[3] == other.bits[3];
+    }
+    constexpr bool operator!=(const CharacterClass &other) const { return !(*this == other); }
+    bool operator<(const CharacterClass &other) const { return bits < other.bits; }
+
+    // 对应 [0] / [9]
+    static constexpr CharacterClass numeric() { return CharacterClass().addRange('0', '9'); }
+    // 对应 [A] / [a]
+    static constexpr CharacterClass literal() { return CharacterClass().addRange('A', 'Z').addRange('a', 'z'); }
+    // 对应 [_] / [-]
+    static constexpr CharacterClass alphaNumeric() { return numeric().add(literal()); }
+
+    /**
+     * Build a class from a custom notation character set.
+     *
+     * By default every character of the set stands for itself, `-` included: `"+-."` accepts
+     * exactly those three characters. With ``SetSyntax::Ranges``, `from-to` is read as a range, e.g.
+     * `a-zA-Z0-9`; a dash that does not sit between two characters in ascending order (such as a
+     * leading or trailing `-`) still stands for itself.
+     */
+    static constexpr CharacterClass fromSet(const char *characterSet, size_t length,
+                                            SetSyntax syntax = SetSyntax::Literal) {
+        const bool ranges = syntax == SetSyntax::Ranges;
+        CharacterClass result;
+        for (size_t i = 0; i < length; ++i) {
+            const char from = characterSet[i];
+            if (ranges && i + 2 < length && characterSet[i + 1] == '-' &&
+                static_cast<unsigned char>(from) <= static_cast<unsigned char>(characterSet[i + 2])) {
+                result.addRange(from, characterSet[i + 2]);
+                i += 2;
+            } else {
+                result.add(from);
+            }
+        }
+        return result;
+    }
+
+    static CharacterClass fromSet(const std::string &characterSet, SetSyntax syntax = SetSyntax::Literal) {
+        return fromSet(characterSet.data(), characterSet.size(), syntax);
+    }
+
+    /**
+     * Canonical, process-wide instance of a class.
+     *
+     * Equal classes share one immutable bitmap that lives until the process exits, so compiled
+     * states can refer to it without owning a copy.
+     */
+    static const CharacterClass *intern(const CharacterClass &characterClass) {
+        static std::mutex mutex;
+        static auto *pool = new std::set<CharacterClass>(); // 有意不释放，保证进程退出前指针始终有效
+        std::lock_guard<std::mutex> lock(mutex);
+        return &*pool->insert(characterClass).first;
+    }
+};
+
+} // namespace TinpMask
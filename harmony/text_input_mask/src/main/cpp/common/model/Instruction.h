@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+namespace TinpMask {
+
+/**
+ * Opcode of a compiled mask instruction, one per ``State`` subclass.
+ */
+enum class InstructionKind : uint8_t { EOL, Fixed, Free, Value, OptionalValue };
+
+/**
+ * Compact record describing a single state of a compiled mask.
+ *
+ * Instructions are stored in one contiguous array inside ``Program`` and reference each other by
+ * index: the next state of instruction `i` is `i + 1`, or `i` itself for elliptical value states.
+ */
+struct Instruction {
+    // 省略号状态：接受字符后停留在自身
+    static constexpr uint8_t Elliptical = 1 << 0;
+
+    InstructionKind kind;   // 指令类型
+    char ownCharacter;      // Fixed/Free 的字面字符；值状态的占位符字符
+    uint8_t characterClass; // 值状态使用的字符类编号（Program::characterClasses 下标）
+    uint8_t flags;          // 指令标志位
+
+    constexpr bool isElliptical() const { return (flags & Elliptical) != 0; }
+};
+
+/**
+ * Value-type result of an instruction transition.
+ *
+ * Plays the role of ``Next`` for the compiled ``Program``: the target state is an instruction
+ * index rather than a reference-counted ``State``.
+ */
+struct Transition {
+    uint32_t state; // 下一条指令的下标
+    char insert;    // 插入到结果中的字符，'\0' 表示不插入
+    bool pass;      // 是否消费当前输入字符
+    char value;     // 写入提取值的字符，'\0' 表示不写入
+};
+
+} // namespace TinpMask
@@ -1,19 +1,22 @@
 #pragma once
-#include <memory>
-#include "State.h"
 
 namespace TinpMask {
 
 class State;
+/**
+ * Value-type transition returned by ``State::accept`` and ``State::autocomplete``.
+ *
+ * Does not own the target state: states are owned by the compiled graph.
+ */
 class Next {
 public:
-    std::shared_ptr<State> state; // 存储状态的智能指针
+    State *state;                 // 下一个状态（非拥有指针）
     char insert;                  // 可插入的字符
     bool pass;                    // 是否通过
     char value;                   // 值字符，可选
 
     // 构造函数
-    Next(std::shared_ptr<State> state, char insert, bool pass, char value)
+    Next(State *state, char insert, bool pass, char value)
         : state(state), insert(insert), pass(pass), value(value) {}
 };
 } // namespace TinpMask
\ No newline at end of file
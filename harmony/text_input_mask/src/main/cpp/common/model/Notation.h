@@ -1,19 +1,23 @@
 #pragma once
 #include <string>
+#include "CharacterClass.h"
 
 namespace TinpMask {
 
 class Notation {
 public:
     // 构造函数
-    Notation(const char character, const std::string &characterSet, bool isOptional)
-        : character(character), characterSet(characterSet), isOptional(isOptional) {}
+    Notation(const char character, const std::string &characterSet, bool isOptional, bool characterRanges = false)
+        : character(character), characterSet(characterSet), isOptional(isOptional),
+          characterRanges(characterRanges) {}
 
     // 成员变量
     char character;           // 单个字符作为字符串
     std::string characterSet; // 字符集
     bool isOptional;          // 是否可选
+    bool characterRanges;     // 字符集中的 a-z 是否按区间解释，默认逐字符
 
-    // 其他方法和成员可以根据需要添加
+    // 字符集对应的字符类；仅在 characterRanges 时支持 a-zA-Z0-9 形式的区间写法
+    CharacterClass characterClass() const { return CharacterClass::fromSet(characterSet, characterRanges ? SetSyntax::Ranges : SetSyntax::Literal); }
 };
 } // namespace TinpMask
\ No newline at end of file
@@ -0,0 +1,209 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CharacterClass.h"
+#include "Instruction.h"
+
+namespace TinpMask {
+
+/**
+ * Facts about the part of a mask that starts at a given instruction, precomputed by
+ * ``Program::indexSuffixes`` so that ``Mask`` answers them without walking the program.
+ */
+struct Suffix {
+    uint32_t placeholderEnd;        // 占位符在 Program::placeholders 中的结束位置（遇到 EOL 或省略号为止）
+    bool complete;                  // 从此处开始已没有必填字符
+    uint32_t acceptableTextLength;  // 剩余的 Fixed/Free/Value 数量
+    uint32_t totalTextLength;       // 剩余的 Fixed/Free/Value/OptionalValue 数量
+    uint32_t acceptableValueLength; // 剩余的 Fixed/Value 数量
+    uint32_t totalValueLength;      // 剩余的 Fixed/Value/OptionalValue 数量
+    uint32_t literalRunLength;      // 从此处开始连续同类 Fixed 或 Free 指令的数量，其余指令为 0
+};
+
+/**
+ * Read-only view of a compiled program, wherever its tables are stored.
+ *
+ * ``Mask::apply`` only interprets programs through this view, so masks compiled at runtime
+ * (``Program``) and masks compiled into the binary (``StaticProgram``) share one interpreter.
+ */
+struct ProgramView {
+    const Instruction *instructions = nullptr;
+    const CharacterClass *characterClasses = nullptr;
+    const char *placeholders = nullptr;
+    const Suffix *suffixes = nullptr;
+    uint32_t instructionCount = 0;
+    uint32_t autocompletableCount = 0;
+
+    constexpr const Instruction &at(uint32_t index) const { return instructions[index]; }
+
+    constexpr const Suffix &suffix(uint32_t index) const { return suffixes[index]; }
+
+    /**
+     * Append the placeholder of the mask part starting at instruction `index` to `output`.
+     */
+    void appendPlaceholder(uint32_t index, std::string &output) const {
+        output.append(placeholders + index, suffixes[index].placeholderEnd - index);
+    }
+
+    // 省略号只能位于 EOL 之前
+    constexpr bool elliptical() const {
+        return instructionCount >= 2 && at(instructionCount - 2).isElliptical();
+    }
+
+    constexpr uint32_t nextState(uint32_t index) const { return at(index).isElliptical() ? index : index + 1; }
+
+    /**
+     * Equivalent of ``State::accept`` for the instruction at `index`.
+     *
+     * @returns `true` and fills `next` if the character is accepted, `false` otherwise.
+     */
+    constexpr bool accept(uint32_t index, char character, Transition &next) const {
+        const Instruction &instruction = at(index);
+        switch (instruction.kind) {
+        case InstructionKind::Fixed:
+            if (instruction.ownCharacter == character) {
+                next = {index + 1, character, true, character};
+            } else {
+                next = {index + 1, instruction.ownCharacter, false, instruction.ownCharacter};
+            }
+            return true;
+        case InstructionKind::Free:
+            if (instruction.ownCharacter == character) {
+                next = {index + 1, character, true, '\0'};
+            } else {
+                next = {index + 1, instruction.ownCharacter, false, '\0'};
+            }
+            return true;
+        case InstructionKind::Value:
+            if (!characterClasses[instruction.characterClass].contains(character)) {
+                return false;
+            }
+            next = {nextState(index), character, true, character};
+            return true;
+        case InstructionKind::OptionalValue:
+            if (characterClasses[instruction.characterClass].contains(character)) {
+                next = {index + 1, character, true, character};
+            } else {
+                next = {index + 1, '\0', false, '\0'};
+            }
+            return true;
+        case InstructionKind::EOL:
+            return false;
+        }
+        return false;
+    }
+
+    /**
+     * Equivalent of ``State::autocomplete`` for the instruction at `index`.
+     *
+     * @returns `true` and fills `next` if the instruction can be autocompleted, `false` otherwise.
+     */
+    constexpr bool autocomplete(uint32_t index, Transition &next) const {
+        const Instruction &instruction = at(index);
+        switch (instruction.kind) {
+        case InstructionKind::Fixed:
+            next = {index + 1, instruction.ownCharacter, false, instruction.ownCharacter};
+            return true;
+        case InstructionKind::Free:
+            next = {index + 1, instruction.ownCharacter, false, '\0'};
+            return true;
+        default:
+            return false;
+        }
+    }
+};
+
+/**
+ * Length of the literal run starting at the Fixed or Free instruction `index`, given the
+ * ``Suffix`` of the instruction after it.
+ *
+ * A run only spans instructions of one kind, so its characters go to the extracted value either
+ * all or none. The characters of the run are the placeholder characters of its instructions.
+ */
+constexpr uint32_t literalRunLength(const Instruction *instructions, size_t index, const Suffix &next) {
+    return instructions[index + 1].kind == instructions[index].kind ? next.literalRunLength + 1 : 1;
+}
+
+/**
+ * Fill the placeholder characters and ``Suffix`` table of `count` instructions.
+ *
+ * Walks the program once, back to front. `placeholders` receives `count - 1` characters (the EOL
+ * instruction has none) and `suffixes` receives `count` entries.
+ */
+constexpr void indexSuffixes(const Instruction *instructions, size_t count, char *placeholders, Suffix *suffixes) {
+    suffixes[count - 1] = Suffix{static_cast<uint32_t>(count - 1), true, 0, 0, 0, 0, 0};
+    for (size_t i = count - 1; i-- > 0;) {
+        const Instruction &instruction = instructions[i];
+        Suffix suffix = suffixes[i + 1];
+        placeholders[i] = instruction.ownCharacter;
+        suffix.totalTextLength += 1;
+        suffix.literalRunLength = 0;
+        switch (instruction.kind) {
+        case InstructionKind::Fixed:
+            suffix.complete = false;
+            suffix.acceptableValueLength += 1;
+            suffix.totalValueLength += 1;
+            suffix.acceptableTextLength += 1;
+            suffix.literalRunLength = literalRunLength(instructions, i, suffixes[i + 1]);
+            break;
+        case InstructionKind::Free:
+            suffix.acceptableTextLength += 1;
+            suffix.literalRunLength = literalRunLength(instructions, i, suffixes[i + 1]);
+            break;
+        case InstructionKind::Value:
+            suffix.complete = instruction.isElliptical();
+            suffix.acceptableValueLength += 1;
+            suffix.totalValueLength += 1;
+            suffix.acceptableTextLength += 1;
+            break;
+        case InstructionKind::OptionalValue:
+            suffix.totalValueLength += 1;
+            break;
+        case InstructionKind::EOL:
+            break;
+        }
+        if (instruction.isElliptical()) {
+            suffix.placeholderEnd = static_cast<uint32_t>(i);
+        }
+        suffixes[i] = suffix;
+    }
+}
+
+/**
+ * Flat, pointer-free representation of a compiled mask.
+ *
+ * Holds one ``Instruction`` per ``State`` of the compiled graph, always terminated by an
+ * ``InstructionKind::EOL`` instruction, plus the table of character classes referenced by value
+ * instructions.
+ */
+class Program {
+public:
+    std::vector<Instruction> instructions;
+    std::vector<CharacterClass> characterClasses; // 本程序引用的字符类位图，按值去重存放
+    // Fixed/Free 指令数量，即 AutocompletionStack 的容量上限
+    uint32_t autocompletableCount = 0;
+    // 各指令的占位符字符依次拼接而成，从第 i 条指令开始的占位符为其中的 [i, suffixes[i].placeholderEnd)
+    std::string placeholders;
+    std::vector<Suffix> suffixes; // 与 instructions 一一对应
+
+    /**
+     * Fill ``placeholders`` and ``suffixes`` from ``instructions``.
+     *
+     * Must be called after the last instruction is added.
+     */
+    void indexSuffixes() {
+        const size_t count = instructions.size();
+        placeholders.assign(count - 1, '\0');
+        suffixes.resize(count);
+        TinpMask::indexSuffixes(instructions.data(), count, &placeholders[0], suffixes.data());
+    }
+
+    // 视图指向本对象的存储，Program 移动或销毁后失效
+    ProgramView view() const {
+        return {instructions.data(), characterClasses.data(), placeholders.data(), suffixes.data(),
+                static_cast<uint32_t>(instructions.size()), autocompletableCount};
+    }
+};
+
+} // namespace TinpMask
@@ -1,17 +1,53 @@
 #pragma once
+#include <string>
 #include "CaretString.h"
-#include "CaretStringIterator.h"
 
 namespace TinpMask {
 
-class RTLCaretStringIterator : public CaretStringIterator {
+/**
+ * Iterates ``CaretString.string`` from its last character to its first, for ``RTLMask``.
+ *
+ * `currentIndex` counts the characters read so far, i.e. it is a position in the reversed string,
+ * and the caret is measured from the end of the string accordingly. The caret rule of the gravity
+ * is the one ``CaretStringIterator`` applies to the reversed string, so the result matches applying
+ * the mask to the reversed input. Like ``CaretStringIterator``, it is a non-virtual view meant for
+ * the stack.
+ */
+template <CaretString::CaretGravity::Kind Gravity>
+class RTLCaretStringIterator {
+private:
+    const char *characters;
+    int length;
+    int caretFromEnd; // 从末尾算起的光标位置
+    int currentIndex;
+
 public:
-    RTLCaretStringIterator(const CaretString& caretString)
-        : CaretStringIterator(caretString) {}
+    // 逆序读取，不走字面字符的整段比较
+    static constexpr bool ReadsForward = false;
+
+    explicit RTLCaretStringIterator(const CaretString &caretString, int index = 0)
+        : characters(caretString.string.data()), length(static_cast<int>(caretString.string.length())),
+          caretFromEnd(length - caretString.caretPosition), currentIndex(index) {}
+
+    bool insertionAffectsCaret() const {
+        if constexpr (Gravity == CaretString::CaretGravity::Kind::Backward) {
+            return currentIndex < caretFromEnd;
+        } else if constexpr (Gravity == CaretString::CaretGravity::Kind::Forward) {
+            return currentIndex <= caretFromEnd;
+        } else {
+            return false;
+        }
+    }
+
+    bool deletionAffectsCaret() const { return currentIndex < caretFromEnd; }
 
-    bool insertionAffectsCaret()  {
-        return currentIndex <= caretString.caretPosition;
+    char next() {
+        if (currentIndex >= length) {
+            return '\0';
+        }
+        currentIndex += 1;
+        return characters[length - currentIndex];
     }
 };
 
-}
\ No newline at end of file
+} // namespace TinpMask
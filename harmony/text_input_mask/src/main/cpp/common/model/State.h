@@ -1,21 +1,30 @@
 #pragma once
-#include <memory>
 #include <iostream>
+#include <optional>
+#include "Next.h"
+#include "CharacterClass.h"
 
 namespace TinpMask {
 
-
-class Next;
+/**
+ * Node of a compiled state graph.
+ *
+ * States live in the ``StateArena`` passed to ``Compiler`` and point to each other without owning:
+ * the arena releases the whole graph at once, so states are trivially destructible and are never
+ * deleted through a `State` pointer.
+ */
 class State {
 public:
-    std::shared_ptr<State> child; // 指向下一个状态的智能指针
+    State *child; // 下一个状态（非拥有指针）
 
 public:
     // 构造函数
-    explicit State(std::shared_ptr<State> child = nullptr) : child(child) {}
+    explicit State(State *child = nullptr) : child(child) {}
+
+protected:
+    ~State() = default;
 
-    // 虚析构函数，以确保派生类的析构函数被正确调用
-    virtual ~State() = default;
+public:
 
     /**
      * Abstract method.
@@ -25,21 +34,21 @@ public:
      *
      * @param character character from the user input string.
      *
-     * @returns Next object instance with a set of actions that should take place when the user
-     * input character is accepted.
+     * @returns Next value with a set of actions that should take place when the user input
+     * character is accepted, or `std::nullopt` if the character is rejected.
      *
      * @throws Fatal error, if the method is not implemented.
      */
-    virtual std::shared_ptr<Next> accept(char character) = 0;
+    virtual std::optional<Next> accept(char character) = 0;
 
     /**
      * Automatically complete user input.
      *
-     * @returns Next object instance with a set of actions to complete user input. If no
-     * autocomplete available, returns nullptr.
+     * @returns Next value with a set of actions to complete user input. If no autocomplete
+     * available, returns `std::nullopt`.
      */
-    virtual std::shared_ptr<Next> autocomplete() {
-        return nullptr; // 默认返回 nullptr
+    virtual std::optional<Next> autocomplete() {
+        return std::nullopt; // 默认不可自动完成
     }
 
     /**
@@ -50,7 +59,7 @@ public:
      *
      * @returns State object.
      */
-    virtual std::shared_ptr<State> nextState() {
+    virtual State *nextState() {
         return child; // 返回下一个状态
     }
 
@@ -61,10 +70,10 @@ public:
 // EOLState 类的实现
 class EOLState : public State {
 public:
-    EOLState(std::shared_ptr<State> child = nullptr) : State(child) {}
+    EOLState(State *child = nullptr) : State(child) {}
 
-    std::shared_ptr<Next> accept(char character) override {
-        return nullptr; // 该状态不接受字符
+    std::optional<Next> accept(char) override {
+        return std::nullopt; // 该状态不接受字符
     }
 
     std::string toString() const override {
@@ -79,18 +88,18 @@ public:
     char ownCharacter;
 
 public:
-    FixedState(std::shared_ptr<State> child, char ownCharacter) : State(child), ownCharacter(ownCharacter) {}
+    FixedState(State *child, char ownCharacter) : State(child), ownCharacter(ownCharacter) {}
 
-    std::shared_ptr<Next> accept(char character) override {
+    std::optional<Next> accept(char character) override {
         if (this->ownCharacter == character) {
-            return std::make_shared<Next>(this->nextState(), character, true, character);
+            return Next(this->nextState(), character, true, character);
         } else {
-            return std::make_shared<Next>(this->nextState(), this->ownCharacter, false, this->ownCharacter);
+            return Next(this->nextState(), this->ownCharacter, false, this->ownCharacter);
         }
     }
 
-    std::shared_ptr<Next> autocomplete() override {
-        return std::make_shared<Next>(this->nextState(), this->ownCharacter, false, this->ownCharacter);
+    std::optional<Next> autocomplete() override {
+        return Next(this->nextState(), this->ownCharacter, false, this->ownCharacter);
     }
 
     std::string toString() const override {
@@ -104,18 +113,18 @@ public:
     char ownCharacter;
 
 public:
-    FreeState(std::shared_ptr<State> child, char ownCharacter) : State(child), ownCharacter(ownCharacter) {}
+    FreeState(State *child, char ownCharacter) : State(child), ownCharacter(ownCharacter) {}
 
-    std::shared_ptr<Next> accept(char character) override {
+    std::optional<Next> accept(char character) override {
         if (this->ownCharacter == character) {
-            return std::make_shared<Next>(this->nextState(), character, true, '\0');
+            return Next(this->nextState(), character, true, '\0');
         } else {
-            return std::make_shared<Next>(this->nextState(), this->ownCharacter, false, '\0');
+            return Next(this->nextState(), this->ownCharacter, false, '\0');
         }
     }
 
-    std::shared_ptr<Next> autocomplete() override {
-        return std::make_shared<Next>(this->nextState(), this->ownCharacter, false, '\0');
+    std::optional<Next> autocomplete() override {
+        return Next(this->nextState(), this->ownCharacter, false, '\0');
     }
 
     std::string toString() const override {
@@ -123,72 +132,83 @@ public:
     }
 };
 enum StateTypeName { Numeric, Literal, AlphaNumeric, Custom };
+
+// 内置字符类的驻留实例
+inline const CharacterClass *numericCharacterClass() {
+    static const CharacterClass *characterClass = CharacterClass::intern(CharacterClass::numeric());
+    return characterClass;
+}
+inline const CharacterClass *literalCharacterClass() {
+    static const CharacterClass *characterClass = CharacterClass::intern(CharacterClass::literal());
+    return characterClass;
+}
+inline const CharacterClass *alphaNumericCharacterClass() {
+    static const CharacterClass *characterClass = CharacterClass::intern(CharacterClass::alphaNumeric());
+    return characterClass;
+}
+
 class OptionalValueState : public State {
 public:
+    // 内置类型无状态，共享静态实例；自定义类型与省略号分配在 StateArena 中
     class OptionalValueStateType {
     public:
-        virtual StateTypeName getName() = 0;
+        virtual StateTypeName getName() const = 0;
+        virtual const CharacterClass *characterClass() const = 0;
+
+    protected:
+        ~OptionalValueStateType() = default;
     };
 
     class Numeric : public OptionalValueStateType {
     public:
-        StateTypeName getName() override { return StateTypeName::Numeric; }
+        StateTypeName getName() const override { return StateTypeName::Numeric; }
+        const CharacterClass *characterClass() const override { return numericCharacterClass(); }
     };
     class Literal : public OptionalValueStateType {
     public:
-        StateTypeName getName() override { return StateTypeName::Literal; }
+        StateTypeName getName() const override { return StateTypeName::Literal; }
+        const CharacterClass *characterClass() const override { return literalCharacterClass(); }
     };
     class AlphaNumeric : public OptionalValueStateType {
     public:
-        StateTypeName getName() override { return StateTypeName::AlphaNumeric; }
+        StateTypeName getName() const override { return StateTypeName::AlphaNumeric; }
+        const CharacterClass *characterClass() const override { return alphaNumericCharacterClass(); }
     };
 
     class Custom : public OptionalValueStateType {
     public:
         char character;
-        std::string characterSet;
-        StateTypeName getName() override { return StateTypeName::Custom; }
-        Custom(char character, const std::string &characterSet) : character(character), characterSet(characterSet) {}
+        const CharacterClass *characterSet; // 驻留的字符类，不持有副本
+        StateTypeName getName() const override { return StateTypeName::Custom; }
+        const CharacterClass *characterClass() const override { return characterSet; }
+        Custom(char character, const CharacterClass *characterSet) : character(character), characterSet(characterSet) {}
     };
 
 public:
-    std::shared_ptr<OptionalValueStateType> type;
-
-    bool accepts(char character) {
-        if (dynamic_cast<Numeric *>(type.get())) {
-            return std::isdigit(character);
-        } else if (dynamic_cast<Literal *>(type.get())) {
-            return std::isalpha(character);
-        } else if (dynamic_cast<AlphaNumeric *>(type.get())) {
-            return std::isalnum(character);
-        } else if (auto customType = dynamic_cast<Custom *>(type.get())) {
-            return customType->characterSet.find(character) != std::string::npos;
-        }
-        return false;
-    }
+    const OptionalValueStateType *type;
+    const CharacterClass *characterClass; // 编译期解析的字符类
 
-    OptionalValueState(std::shared_ptr<State> child, std::shared_ptr<OptionalValueStateType> type)
-        : State(child), type(type) {}
+    bool accepts(char character) const { return characterClass->contains(character); }
 
-    OptionalValueState(std::shared_ptr<State> child, std::shared_ptr<OptionalValueStateType> &type)
-        : State(child), type(type) {}
+    OptionalValueState(State *child, const OptionalValueStateType *type)
+        : State(child), type(type), characterClass(type->characterClass()) {}
 
-    std::shared_ptr<Next> accept(char character) override {
+    std::optional<Next> accept(char character) override {
         if (this->accepts(character)) {
-            return std::make_shared<Next>(this->nextState(), character, true, character);
+            return Next(this->nextState(), character, true, character);
         } else {
-            return std::make_shared<Next>(this->nextState(), '\0', false, '\0');
+            return Next(this->nextState(), '\0', false, '\0');
         }
     }
 
     std::string toString() const override {
-        if (dynamic_cast<Literal *>(type.get())) {
+        if (dynamic_cast<const Literal *>(type)) {
             return "[a] -> " + (child ? child->toString() : "null");
-        } else if (dynamic_cast<Numeric *>(type.get())) {
+        } else if (dynamic_cast<const Numeric *>(type)) {
             return "[9] -> " + (child ? child->toString() : "null");
-        } else if (dynamic_cast<AlphaNumeric *>(type.get())) {
+        } else if (dynamic_cast<const AlphaNumeric *>(type)) {
             return "[-] -> " + (child ? child->toString() : "null");
-        } else if (auto customType = dynamic_cast<Custom *>(type.get())) {
+        } else if (auto customType = dynamic_cast<const Custom *>(type)) {
             return "[" + std::string(1, customType->character) + "] -> " + (child ? child->toString() : "null");
         }
         return "unknown -> null";
@@ -196,97 +216,81 @@ public:
 };
 
 // ValueState 类定义
-class ValueState : public State, public std::enable_shared_from_this<ValueState> {
+class ValueState : public State {
 public:
+    // 内置类型无状态，共享静态实例；自定义类型与省略号分配在 StateArena 中
     class ValueStateType {
     public:
-        virtual StateTypeName getName() = 0;
+        virtual StateTypeName getName() const = 0;
+        virtual const CharacterClass *characterClass() const = 0;
+
+    protected:
+        ~ValueStateType() = default;
     };
 
     class Numeric : public ValueStateType {
     public:
-        StateTypeName getName() override { return StateTypeName::Numeric; }
+        StateTypeName getName() const override { return StateTypeName::Numeric; }
+        const CharacterClass *characterClass() const override { return numericCharacterClass(); }
     };
     class Literal : public ValueStateType {
     public:
-        StateTypeName getName() override { return StateTypeName::Literal; }
+        StateTypeName getName() const override { return StateTypeName::Literal; }
+        const CharacterClass *characterClass() const override { return literalCharacterClass(); }
     };
     class AlphaNumeric : public ValueStateType {
     public:
-        StateTypeName getName() override { return StateTypeName::AlphaNumeric; }
+        StateTypeName getName() const override { return StateTypeName::AlphaNumeric; }
+        const CharacterClass *characterClass() const override { return alphaNumericCharacterClass(); }
     };
     class Ellipsis : public ValueStateType {
     public:
-        std::shared_ptr<ValueStateType> inheritedType;
-        explicit Ellipsis(std::shared_ptr<ValueStateType> inheritedType) : inheritedType(inheritedType) {}
-        StateTypeName getName() override { return StateTypeName::Custom; }
+        const ValueStateType *inheritedType;
+        explicit Ellipsis(const ValueStateType *inheritedType) : inheritedType(inheritedType) {}
+        StateTypeName getName() const override { return StateTypeName::Custom; }
+        const CharacterClass *characterClass() const override { return inheritedType->characterClass(); }
     };
     class Custom : public ValueStateType {
 
     public:
         char character;
-        std::string characterSet;
-        Custom(char character, const std::string &characterSet) : character(character), characterSet(characterSet) {}
-        StateTypeName getName() override { return StateTypeName::Custom; }
+        const CharacterClass *characterSet; // 驻留的字符类，不持有副本
+        Custom(char character, const CharacterClass *characterSet) : character(character), characterSet(characterSet) {}
+        StateTypeName getName() const override { return StateTypeName::Custom; }
+        const CharacterClass *characterClass() const override { return characterSet; }
     };
 
 public:
-    std::shared_ptr<ValueStateType> type;
-    bool accepts(char character) {
-        if (dynamic_cast<Numeric *>(type.get())) {
-            return std::isdigit(character);
-        } else if (dynamic_cast<Literal *>(type.get())) {
-            return std::isalpha(character);
-        } else if (dynamic_cast<AlphaNumeric *>(type.get())) {
-            return std::isalnum(character);
-        } else if (auto ellipsisType = dynamic_cast<Ellipsis *>(type.get())) {
-            return acceptsWithInheritedType(ellipsisType->inheritedType, character);
-        } else if (auto customType = dynamic_cast<Custom *>(type.get())) {
-            return customType->characterSet.find(character) != std::string::npos;
-        }
-        return false;
-    }
+    const ValueStateType *type;
+    const CharacterClass *characterClass; // 编译期解析的字符类（省略号状态取继承类型的字符类）
 
-    bool acceptsWithInheritedType(std::shared_ptr<ValueStateType> inheritedType, char character) {
-        if (dynamic_cast<Numeric *>(inheritedType.get())) {
-            return std::isdigit(character);
-        } else if (dynamic_cast<Literal *>(inheritedType.get())) {
-            return std::isalpha(character);
-        } else if (dynamic_cast<AlphaNumeric *>(inheritedType.get())) {
-            return std::isalnum(character);
-        } else if (auto customType = dynamic_cast<Custom *>(inheritedType.get())) {
-            return customType->characterSet.find(character) != std::string::npos;
-        }
-        return false;
-    }
+    bool accepts(char character) const { return characterClass->contains(character); }
 
 public:
-    // 构造函数用于创建 Ellipsis 类型的 ValueState
-    ValueState(std::shared_ptr<ValueStateType> inheritedType)
-        : State(nullptr), type(std::make_shared<Ellipsis>(inheritedType)) {}
-
-    ValueState(std::shared_ptr<State> child, std::shared_ptr<ValueStateType> type) : State(child), type(type) {}
+    // 省略号状态以 Ellipsis 类型、无子状态构造
+    ValueState(State *child, const ValueStateType *type)
+        : State(child), type(type), characterClass(type->characterClass()) {}
 
-    std::shared_ptr<Next> accept(char character) override {
+    std::optional<Next> accept(char character) override {
         if (!accepts(character))
-            return nullptr;
-        return std::make_shared<Next>(nextState(), character, true, character);
+            return std::nullopt;
+        return Next(nextState(), character, true, character);
     }
 
-    bool isElliptical() const { return dynamic_cast<Ellipsis *>(type.get()) != nullptr; }
+    bool isElliptical() const { return dynamic_cast<const Ellipsis *>(type) != nullptr; }
 
-    std::shared_ptr<State> nextState() override { return isElliptical() ? shared_from_this() : State::nextState(); }
+    State *nextState() override { return isElliptical() ? this : State::nextState(); }
 
     std::string toString() const override {
-        if (dynamic_cast<Literal *>(type.get())) {
+        if (dynamic_cast<const Literal *>(type)) {
             return "[A] -> " + (child ? child->toString() : "null");
-        } else if (dynamic_cast<Numeric *>(type.get())) {
+        } else if (dynamic_cast<const Numeric *>(type)) {
             return "[0] -> " + (child ? child->toString() : "null");
-        } else if (dynamic_cast<AlphaNumeric *>(type.get())) {
+        } else if (dynamic_cast<const AlphaNumeric *>(type)) {
             return "[_] -> " + (child ? child->toString() : "null");
-        } else if (dynamic_cast<Ellipsis *>(type.get())) {
+        } else if (dynamic_cast<const Ellipsis *>(type)) {
             return "[…] -> " + (child ? child->toString() : "null");
-        } else if (auto customType = dynamic_cast<Custom *>(type.get())) {
+        } else if (auto customType = dynamic_cast<const Custom *>(type)) {
             return "[" + std::string(1, customType->character) + "] -> " + (child ? child->toString() : "null");
         }
         return "unknown -> null";
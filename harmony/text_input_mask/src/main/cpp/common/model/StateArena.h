@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace TinpMask {
+
+/**
+ * Monotonic storage for a compiled ``State`` graph and its value type descriptors.
+ *
+ * Objects are placement-constructed into a few large blocks and linked by raw pointers; none of
+ * them owns another. Only trivially destructible types are accepted, so releasing the graph frees
+ * the blocks without visiting a single state. Moving the arena hands over the blocks without
+ * relocating any object, so pointers into the graph survive a move of the arena itself.
+ */
+class StateArena {
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> bytes;
+        size_t capacity;
+    };
+
+    std::vector<Block> blocks;
+    size_t used = 0; // 最后一个块中已使用的字节数
+
+public:
+    StateArena() = default;
+
+    // capacity 为预计的总字节数，足够时整张图只占一个块
+    explicit StateArena(size_t capacity) { addBlock(capacity); }
+
+    StateArena(StateArena &&) = default;
+    StateArena &operator=(StateArena &&) = default;
+    StateArena(const StateArena &) = delete;
+    StateArena &operator=(const StateArena &) = delete;
+
+    template <typename T, typename... Args> T *make(Args &&...args) {
+        static_assert(std::is_trivially_destructible_v<T>, "StateArena never runs destructors");
+        void *memory = allocate(sizeof(T), alignof(T));
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    // 保证接下来 bytes 字节的分配不再追加块（对齐填充另计）
+    void reserve(size_t bytes) {
+        if (blocks.empty() || blocks.back().capacity - used < bytes) {
+            addBlock(bytes);
+        }
+    }
+
+private:
+    void *allocate(size_t size, size_t alignment) {
+        if (!blocks.empty()) {
+            const Block &block = blocks.back();
+            const size_t offset = (used + alignment - 1) & ~(alignment - 1);
+            if (offset + size <= block.capacity) {
+                used = offset + size;
+                return block.bytes.get() + offset;
+            }
+        }
+        // 预估不足时追加一个块，已分配的对象不移动
+        addBlock(std::max(size + alignment, blocks.empty() ? size_t(256) : blocks.back().capacity * 2));
+        return allocate(size, alignment);
+    }
+
+    void addBlock(size_t capacity) {
+        // new std::byte[] 按 max_align_t 对齐，块内偏移对齐即可
+        blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[capacity]), capacity});
+        used = 0;
+    }
+};
+
+} // namespace TinpMask
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace TinpMask {
+
+/**
+ * Conversions between UTF-8 byte offsets, used by ``CaretString``, and UTF-16 code unit offsets,
+ * used by ArkUI text input caret and selection attributes.
+ *
+ * Characters outside the BMP take two UTF-16 units. An offset that falls inside a character is
+ * moved to the end of that character. Malformed UTF-8 is counted one unit per lead byte.
+ */
+
+// UTF-8 字节 lead 对应的 UTF-16 单元数；续字节为 0
+inline int32_t utf16UnitsOf(uint8_t lead) {
+    if ((lead & 0xC0) == 0x80) {
+        return 0;
+    }
+    return lead >= 0xF0 ? 2 : 1;
+}
+
+/**
+ * @returns UTF-16 offset of the character boundary at or after `byteOffset` in `text`.
+ */
+inline int32_t utf16OffsetOf(std::string_view text, size_t byteOffset) {
+    int32_t units = 0;
+    size_t index = 0;
+    for (; index < text.size() && index < byteOffset; ++index) {
+        units += utf16UnitsOf(static_cast<uint8_t>(text[index]));
+    }
+    return units;
+}
+
+/**
+ * @returns Byte offset in `text` of the character boundary at or after `utf16Offset`, clamped to
+ * the text length.
+ */
+inline size_t byteOffsetOf(std::string_view text, int32_t utf16Offset) {
+    int32_t units = 0;
+    size_t index = 0;
+    while (index < text.size()) {
+        const int32_t width = utf16UnitsOf(static_cast<uint8_t>(text[index]));
+        // 只在字符边界（lead 字节）处停下
+        if (width != 0 && units >= utf16Offset) {
+            break;
+        }
+        units += width;
+        index += 1;
+    }
+    return index;
+}
+
+} // namespace TinpMask
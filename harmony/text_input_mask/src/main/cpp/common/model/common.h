@@ -1,12 +1,20 @@
 #pragma once
 #include "CaretString.h"
+#include <array>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include "State.h"
 #include "Next.h"
+#include "Instruction.h"
 
 namespace TinpMask {
 
+// 格式中的省略号 "…"（U+2026）的 UTF-8 编码，表示可无限重复的值状态
+constexpr char EllipsisSymbol[] = "\xE2\x80\xA6";
+constexpr size_t EllipsisSymbolLength = sizeof(EllipsisSymbol) - 1;
+
 class Result {
 public:
     // 属性
@@ -17,10 +25,11 @@ public:
     std::string tailPlaceholder;
 
     // 构造函数
-    Result(const CaretString &formattedText, const std::string &extractedValue, int affinity, bool complete,
-           const std::string &tailPlaceholder)
-        : formattedText(formattedText), extractedValue(extractedValue), affinity(affinity), complete(complete),
-          tailPlaceholder(tailPlaceholder) {}
+    // 按值接收并移入，调用方传右值时不拷贝字符串
+    Result(CaretString formattedText, std::string extractedValue, int affinity, bool complete,
+           std::string tailPlaceholder)
+        : formattedText(std::move(formattedText)), extractedValue(std::move(extractedValue)), affinity(affinity),
+          complete(complete), tailPlaceholder(std::move(tailPlaceholder)) {}
 
     // reversed 方法
     Result reversed() const {
@@ -37,53 +46,57 @@ private:
  * autocompletion steps.
  *
  * This graph accumulates the results of `.autocomplete()` calls for each consecutive ``State``,
- * acting as a `stack` of ``Next`` object instances.
+ * acting as a `stack` of ``Transition`` values.
  *
- * Each time the ``State`` returns `null` for its `.autocomplete()`, the graph resets empty.
+ * Every instruction pushes at most once per `.apply(…)` call, so the stack never grows past the
+ * number of autocompletable instructions of the mask. Stacks bounded by ``InlineCapacity`` live
+ * entirely inline; larger masks reserve their bound once, up front.
  */
 class AutocompletionStack {
+public:
+    static constexpr size_t InlineCapacity = 64;
+
 private:
-    std::vector<Next> stack;
+    std::array<Transition, InlineCapacity> inlineStack;
+    std::unique_ptr<Transition[]> heapStack;
+    Transition *stack = nullptr;
+    size_t count = 0;
 
 public:
-    // Push 方法
-    std::optional<Next> push(const std::optional<Next> &item) {
-        if (item.has_value()) {
-            stack.push_back(item.value());
-            return item;
+    // capacity 为栈的上限（掩码中可自动完成的指令数）
+    explicit AutocompletionStack(size_t capacity) {
+        if (capacity > InlineCapacity) {
+            heapStack = std::make_unique<Transition[]>(capacity);
+            stack = heapStack.get();
         } else {
-            clear();             // 清空栈
-            return std::nullopt; // 返回 std::nullopt
+            stack = inlineStack.data();
         }
     }
 
-    // 清空栈的方法
-    void clear() { stack.clear(); }
+    AutocompletionStack(const AutocompletionStack &) = delete;
+    AutocompletionStack &operator=(const AutocompletionStack &) = delete;
 
-    // Optional: 获取栈的元素（用于检查或调试）
-    std::vector<Next> getStack() const {
-        return stack; // 返回当前栈的拷贝
-    }
+    // Push 方法
+    void push(const Transition &item) { stack[count++] = item; }
 
-    // Optional: 从栈中弹出一个元素
-    std::optional<Next> pop() {
-        if (stack.empty()) {
-            return std::nullopt; // 栈为空时返回 std::nullopt
-        }
-        Next item = stack.back();
-        stack.pop_back();
-        return item;
-    }
+    // 清空栈的方法
+    void clear() { count = 0; }
+
+    // 从栈中弹出一个元素，调用方需保证栈非空
+    Transition pop() { return stack[--count]; }
 
     // 检查栈是否为空
-    bool isEmpty() const { return stack.empty(); }
+    bool isEmpty() const { return count == 0; }
 
-    // Optional: 获取栈顶元素而不移除它
-    std::optional<Next> peek() const {
-        if (stack.empty()) {
-            return std::nullopt; // 栈为空时返回 std::nullopt
-        }
-        return stack.back();
-    }
+    // 获取栈顶元素而不移除它，调用方需保证栈非空
+    const Transition &peek() const { return stack[count - 1]; }
+
+    // 按下标（自栈底起）访问元素
+    const Transition &at(size_t index) const { return stack[index]; }
+
+    // 回退到指定深度，用于从检查点恢复扫描
+    void truncate(size_t depth) { count = depth < count ? depth : count; }
+
+    size_t size() const { return count; }
 };
 } // namespace TinpMask
\ No newline at end of file
@@ -16,8 +16,51 @@ export class RNTextInputMaskTurboModule extends TurboModule  {
     return;
   }
 
+  maskSync(mask: string, value: string, autocomplete: boolean, customNotations?: object[]): string | null {
+    return null;
+  }
+
+  unmaskSync(mask: string, value: string, autocomplete: boolean, customNotations?: object[]): string | null {
+    return null;
+  }
+
+  compileMask(mask: string, options: object): object | null {
+    return null;
+  }
+
+  trimMaskCache(targetBytes?: number): void {
+  }
+
+  maskCacheStats(): object {
+    return {};
+  }
+
+  persistMaskCache(): boolean {
+    return false;
+  }
+
+  // 供原生模块构造时读取，编译好的掩码缓存在此目录下
+  getCacheDir(): string {
+    return this.context.uiAbilityContext?.cacheDir ?? '';
+  }
+
+  prewarmMasks(formats: string[], options: object): Promise<number> {
+    return;
+  }
+
+  maskBatch(mask: string, values: string[] | ArrayBuffer, options: object): Promise<string[] | ArrayBuffer> {
+    return;
+  }
+
+  unmaskBatch(mask: string, values: string[] | ArrayBuffer, options: object): Promise<string[] | ArrayBuffer> {
+    return;
+  }
+
   setMask(reactNode: number, primaryFormat: string, options: object): void {
     console.log("==================", "setMask")
   }
 
+  unsetMask(reactNode: number): void {
+  }
+
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "common/Mask.h"
+#include "common/RTLMask.h"
+#include "MaskTestSupport.h"
+
+namespace TinpMask {
+namespace {
+
+using test::backward;
+using test::expectSameResult;
+using test::forward;
+
+const std::vector<std::string> Formats = {
+    "+7 ([000]) [000]-[00]-[00]", "[0000] [0000] [0000] [0000]", "[00]{.}[00]{.}[0000]", "[…]", "[0…]",
+    "{IBAN }[00] [0000][…]",      "[AAA]-[000]",                 "[09]{.}[09]",          "[d]-[DD]",
+};
+const std::vector<Notation> Notations = {Notation('d', "0123456789", false), Notation('D', "ABCDEF", true)};
+
+TEST(ApplySessionTest, TypingAPhoneNumber) {
+    Mask mask("+7 ([000]) [000]-[00]-[00]");
+    ApplySession session;
+    const std::string digits = "9123456789";
+    std::string text;
+    for (char digit : digits) {
+        text = session.lastResult().formattedText.string + digit;
+        mask.apply(CaretString(text, static_cast<int>(text.length()), forward(true)), session);
+    }
+    const Result &result = session.lastResult();
+    EXPECT_EQ(result.formattedText.string, "+7 (912) 345-67-89");
+    EXPECT_EQ(result.formattedText.caretPosition, 18);
+    EXPECT_EQ(result.extractedValue, "9123456789");
+    EXPECT_TRUE(result.complete);
+}
+
+TEST(ApplySessionTest, PartialInputIsAutocompleted) {
+    Mask mask("+7 ([000]) [000]-[00]-[00]");
+    ApplySession session;
+    const Result &first = mask.apply(CaretString("9", 1, forward(true)), session);
+    EXPECT_EQ(first.formattedText.string, "+7 (9");
+    EXPECT_EQ(first.formattedText.caretPosition, 5);
+    EXPECT_EQ(first.extractedValue, "9");
+    EXPECT_EQ(first.tailPlaceholder, "00) 000-00-00");
+    EXPECT_FALSE(first.complete);
+
+    const Result &second = mask.apply(CaretString("912", 3, forward(true)), session);
+    EXPECT_EQ(second.formattedText.string, "+7 (912) ");
+    EXPECT_EQ(second.extractedValue, "912");
+    EXPECT_EQ(second.tailPlaceholder, "000-00-00");
+}
+
+TEST(ApplySessionTest, DeletingInTheMiddleMatchesFullApply) {
+    Mask mask("[0000] [0000] [0000] [0000]");
+    ApplySession session;
+    mask.apply(CaretString("1234 5678 9012 3456", 19, forward(true)), session);
+    const CaretString edited("1234 578 9012 3456", 6, backward(false));
+    const Result &result = mask.apply(edited, session);
+    EXPECT_EQ(result.formattedText.string, "1234 5789 0123 456");
+    EXPECT_EQ(result.formattedText.caretPosition, 6);
+    expectSameResult(result, mask.apply(edited), "middle deletion");
+}
+
+// 同一会话中换用其他重力或开关：检查点作废，结果与完整 apply 一致
+TEST(ApplySessionTest, SwitchingGravityMatchesFullApply) {
+    const std::vector<std::shared_ptr<CaretString::CaretGravity>> gravities = {
+        forward(true), backward(false), forward(false), backward(true), std::make_shared<CaretString::CaretGravity>()};
+    for (const std::string &format : Formats) {
+        Mask mask(format, Notations);
+        ApplySession session;
+        const std::string text = "12AB.34-5678 90";
+        for (int caret = 0; caret <= static_cast<int>(text.length()); ++caret) {
+            for (const auto &gravity : gravities) {
+                const CaretString input(text, caret, gravity);
+                expectSameResult(mask.apply(input, session), mask.apply(input),
+                                 format + " caret " + std::to_string(caret));
+            }
+        }
+    }
+
+    Mask mask("+7 ([000]) [000]-[00]-[00]");
+    ApplySession session;
+    mask.apply(CaretString("+7 (912) 3", 10, forward(true)), session);
+    const Result &result = mask.apply(CaretString("+7 (912) 3", 10, backward(false)), session);
+    EXPECT_EQ(result.formattedText.string, "+7 (912) 3");
+    EXPECT_EQ(result.formattedText.caretPosition, 10);
+    EXPECT_EQ(result.tailPlaceholder, "00-00-00");
+}
+
+// 随机编辑序列：每一步的增量结果都必须与完整 apply 一致
+TEST(ApplySessionTest, RandomEditsMatchFullApply) {
+    std::mt19937 random(20240601);
+    const std::string alphabet = "0123456789abcAB-.() ";
+    for (int sequence = 0; sequence < 3000; ++sequence) {
+        const std::string &format = Formats[random() % Formats.size()];
+        const bool rightToLeft = random() % 5 == 0;
+        std::unique_ptr<Mask> mask = rightToLeft ? std::make_unique<RTLMask>(format, Notations)
+                                                 : std::make_unique<Mask>(format, Notations);
+        ApplySession session;
+        std::string text;
+        for (int step = 0; step < 30; ++step) {
+            switch (random() % 6) {
+            case 0:
+            case 1:
+            case 2:
+                text += alphabet[random() % alphabet.length()];
+                break;
+            case 3:
+                if (!text.empty()) {
+                    text.pop_back();
+                }
+                break;
+            case 4:
+                if (!text.empty()) {
+                    text.erase(random() % text.length(), 1);
+                }
+                break;
+            default:
+                // 用格式化后的文本替换输入，模拟粘贴与回写
+                text = mask->apply(CaretString(text, static_cast<int>(text.length()), forward(true)))
+                           .formattedText.string;
+                break;
+            }
+            const int caret =
+                random() % 4 == 0 ? static_cast<int>(random() % (text.length() + 1)) : static_cast<int>(text.length());
+            const CaretString input(text, caret, test::randomGravity(random));
+            const Result &incremental = mask->apply(input, session);
+            expectSameResult(incremental, mask->apply(input),
+                             format + (rightToLeft ? " (RTL) " : " ") + "'" + text + "' caret " + std::to_string(caret));
+            if (HasFailure()) {
+                return;
+            }
+        }
+    }
+}
+
+} // namespace
+} // namespace TinpMask
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "common/Mask.h"
+
+namespace TinpMask {
+namespace {
+
+TEST(CharacterClassTest, CustomSetIsLiteral) {
+    const CharacterClass characterClass = CharacterClass::fromSet("+-.");
+    EXPECT_TRUE(characterClass.contains('+'));
+    EXPECT_TRUE(characterClass.contains('-'));
+    EXPECT_TRUE(characterClass.contains('.'));
+    // '+' 与 '.' 之间的 ',' 不能被当成区间的一部分
+    EXPECT_FALSE(characterClass.contains(','));
+}
+
+TEST(CharacterClassTest, DashBetweenLettersIsNotARange) {
+    const CharacterClass characterClass = CharacterClass::fromSet("a-z");
+    EXPECT_TRUE(characterClass.contains('a'));
+    EXPECT_TRUE(characterClass.contains('-'));
+    EXPECT_TRUE(characterClass.contains('z'));
+    EXPECT_FALSE(characterClass.contains('m'));
+}
+
+TEST(CharacterClassTest, RangesAreOptIn) {
+    const CharacterClass characterClass = CharacterClass::fromSet("a-zA-Z0-9", SetSyntax::Ranges);
+    EXPECT_TRUE(characterClass.contains('m'));
+    EXPECT_TRUE(characterClass.contains('Q'));
+    EXPECT_TRUE(characterClass.contains('5'));
+    EXPECT_FALSE(characterClass.contains('-'));
+    EXPECT_FALSE(characterClass.contains('_'));
+    // 与内置的 [_] 字符类相同
+    EXPECT_TRUE(characterClass == CharacterClass::alphaNumeric());
+}
+
+TEST(CharacterClassTest, DashOutsideARangeIsLiteral) {
+    // 首尾的 '-' 以及降序的 z-a 都按字面字符处理
+    const CharacterClass edges = CharacterClass::fromSet("-0-9-", SetSyntax::Ranges);
+    EXPECT_TRUE(edges.contains('-'));
+    EXPECT_TRUE(edges.contains('4'));
+    EXPECT_FALSE(edges.contains('a'));
+
+    const CharacterClass descending = CharacterClass::fromSet("z-a", SetSyntax::Ranges);
+    EXPECT_TRUE(descending.contains('z'));
+    EXPECT_TRUE(descending.contains('-'));
+    EXPECT_TRUE(descending.contains('a'));
+    EXPECT_FALSE(descending.contains('m'));
+}
+
+TEST(CharacterClassTest, BuiltInClasses) {
+    EXPECT_TRUE(CharacterClass::numeric().contains('7'));
+    EXPECT_FALSE(CharacterClass::numeric().contains('a'));
+    EXPECT_TRUE(CharacterClass::literal().contains('Q'));
+    EXPECT_FALSE(CharacterClass::literal().contains('\xC3'));
+    EXPECT_TRUE(CharacterClass::alphaNumeric().contains('q'));
+    EXPECT_TRUE(CharacterClass::alphaNumeric().contains('0'));
+    EXPECT_FALSE(CharacterClass::alphaNumeric().contains('_'));
+}
+
+TEST(CharacterClassTest, CustomNotationAcceptsOnlyListedCharacters) {
+    Mask mask("[ss]", {Notation('s', "+-.", false)});
+    CaretString text("+,.", 3, std::make_shared<CaretString::Forward>(false));
+    const Result result = mask.apply(text);
+    EXPECT_EQ(result.formattedText.string, "+.");
+    EXPECT_EQ(result.extractedValue, "+.");
+}
+
+TEST(CharacterClassTest, CustomNotationWithRanges) {
+    Mask mask("[hh]-[hh]", {Notation('h', "0-9a-f", false, true)});
+    CaretString text("1fz9c", 5, std::make_shared<CaretString::Forward>(false));
+    const Result result = mask.apply(text);
+    EXPECT_EQ(result.formattedText.string, "1f-9c");
+    EXPECT_EQ(result.extractedValue, "1f9c");
+    EXPECT_TRUE(result.complete);
+}
+
+TEST(CharacterClassTest, RangeFlagIsPartOfTheCacheKey) {
+    const std::vector<Notation> literal = {Notation('h', "0-9", false)};
+    const std::vector<Notation> ranged = {Notation('h', "0-9", false, true)};
+    EXPECT_NE(MaskCache::key("[hh]", literal, false), MaskCache::key("[hh]", ranged, false));
+    const Result literalResult =
+        Mask::MaskFactory::getOrCreate("[hh]", literal)->apply(CaretString("45", 2, nullptr));
+    const Result rangedResult =
+        Mask::MaskFactory::getOrCreate("[hh]", ranged)->apply(CaretString("45", 2, nullptr));
+    EXPECT_EQ(literalResult.extractedValue, "");
+    EXPECT_EQ(rangedResult.extractedValue, "45");
+}
+
+} // namespace
+} // namespace TinpMask
@@ -0,0 +1,29 @@
+// 格式长度扫描：编译耗时应随格式长度线性增长（每字符耗时大致不变）
+// 不是 CTest 用例；构建后手动运行 ./CompileLengthSweep
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "common/Mask.h"
+
+int main() {
+    using Clock = std::chrono::steady_clock;
+    std::printf("%8s %12s %10s\n", "length", "us/compile", "ns/char");
+    for (size_t length : {64, 256, 1024, 4096, 16384, 65536}) {
+        // 混合值、转义与固定字符；按完整片段拼接，保证括号闭合
+        std::string format;
+        while (format.length() < length) {
+            format += "[00]{-}\\[[AA] ";
+        }
+        const int repetitions = static_cast<int>(400000 / format.length()) + 1;
+        size_t instructions = 0;
+        const auto start = Clock::now();
+        for (int i = 0; i < repetitions; ++i) {
+            TinpMask::Mask mask(format);
+            instructions += static_cast<size_t>(mask.totalTextLength());
+        }
+        const double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / repetitions;
+        std::printf("%8zu %12.1f %10.1f   (%zu states)\n", format.length(), micros, micros * 1000 / format.length(),
+                    instructions / repetitions);
+    }
+    return 0;
+}
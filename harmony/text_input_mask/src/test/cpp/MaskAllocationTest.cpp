@@ -0,0 +1,104 @@
+#include <cstdlib>
+#include <new>
+#include <gtest/gtest.h>
+#include "common/Mask.h"
+#include "common/RTLMask.h"
+#include "MaskTestSupport.h"
+
+namespace {
+// 只统计 counting 为 true 期间的分配
+bool counting = false;
+size_t allocations = 0;
+
+// 不内联，避免 GCC 把内联后的 free 与 operator new 配对误报 -Wmismatched-new-delete
+[[gnu::noinline]] void release(void *memory) noexcept { std::free(memory); }
+} // namespace
+
+void *operator new(size_t size) {
+    if (counting) {
+        allocations += 1;
+    }
+    if (void *memory = std::malloc(size != 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *memory) noexcept { release(memory); }
+void operator delete(void *memory, size_t) noexcept { release(memory); }
+
+namespace TinpMask {
+namespace {
+
+using test::backward;
+using test::forward;
+
+// 在 body 执行期间统计全局 operator new 的调用次数
+template <typename Body> size_t allocationsDuring(Body &&body) {
+    allocations = 0;
+    counting = true;
+    body();
+    counting = false;
+    return allocations;
+}
+
+const std::vector<std::string> Inputs = {"1", "12345678", "123456789012", "1234567890123456", "12-34 5", ""};
+
+// 先用最长的输入预热缓冲区，之后的调用不应再分配
+void expectAllocationFreeApplyInto(Mask &mask, std::shared_ptr<CaretString::CaretGravity> gravity) {
+    MaskOutput output;
+    CaretString text("", 0, std::move(gravity));
+    text.string.reserve(64);
+    for (const std::string &input : Inputs) {
+        text.string = input;
+        text.caretPosition = static_cast<int>(input.length());
+        mask.applyInto(text, output);
+    }
+    const size_t count = allocationsDuring([&] {
+        for (int round = 0; round < 100; ++round) {
+            for (const std::string &input : Inputs) {
+                text.string.assign(input);
+                text.caretPosition = static_cast<int>(input.length()) / (round % 3 + 1);
+                mask.applyInto(text, output);
+            }
+        }
+    });
+    EXPECT_EQ(count, 0u);
+}
+
+TEST(MaskAllocationTest, ApplyIntoDoesNotAllocateOnceWarm) {
+    Mask mask("[000] [000] [000]{.}[00]");
+    expectAllocationFreeApplyInto(mask, forward(true));
+    expectAllocationFreeApplyInto(mask, forward(false));
+    expectAllocationFreeApplyInto(mask, backward(true));
+    expectAllocationFreeApplyInto(mask, backward(false));
+}
+
+TEST(MaskAllocationTest, AutocompletionDoesNotAllocate) {
+    // 大量 Fixed/Free 指令，自动完成栈较深
+    Mask mask("+7 ([000]) [000]-[00]-[00]{ ext. }[0000]");
+    expectAllocationFreeApplyInto(mask, forward(true));
+    expectAllocationFreeApplyInto(mask, backward(true));
+}
+
+TEST(MaskAllocationTest, EllipticalApplyIntoDoesNotAllocateOnceWarm) {
+    Mask mask("{#}[0…]");
+    expectAllocationFreeApplyInto(mask, forward(true));
+}
+
+TEST(MaskAllocationTest, RightToLeftApplyIntoDoesNotAllocateOnceWarm) {
+    RTLMask mask("[000] [000] [000]{.}[00]", std::vector<Notation>());
+    expectAllocationFreeApplyInto(mask, forward(true));
+    expectAllocationFreeApplyInto(mask, backward(true));
+}
+
+TEST(MaskAllocationTest, ApplyAllocatesOnlyTheResult) {
+    Mask mask("[000] [000] [000]{.}[00]");
+    CaretString text("123456789012", 12, forward(true));
+    mask.apply(text);
+    // 至多为结果的三个字符串与自动完成栈各分配一次，与输入长度无关
+    const size_t count = allocationsDuring([&] { mask.apply(text); });
+    EXPECT_LE(count, 4u);
+}
+
+} // namespace
+} // namespace TinpMask
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include "common/MaskSet.h"
+#include "common/RTLMask.h"
+#include "MaskTestSupport.h"
+
+namespace TinpMask {
+namespace {
+
+using test::backward;
+using test::expectSameResult;
+using test::forward;
+
+std::vector<std::shared_ptr<Mask>> masksOf(const std::vector<std::string> &formats, bool rightToLeft = false) {
+    std::vector<std::shared_ptr<Mask>> masks;
+    for (const std::string &format : formats) {
+        if (rightToLeft) {
+            masks.push_back(std::make_shared<RTLMask>(format, std::vector<Notation>()));
+        } else {
+            masks.push_back(std::make_shared<Mask>(format));
+        }
+    }
+    return masks;
+}
+
+// 基线 pickMask 的规则：逐个计算亲和度；primary 不低于最佳 affine 时胜出，否则取第一个最佳 affine
+size_t referenceWinner(const std::vector<std::shared_ptr<Mask>> &masks, AffinityCalculationStrategy strategy,
+                       const CaretString &text, std::vector<int> &affinities) {
+    affinities.clear();
+    for (const auto &mask : masks) {
+        affinities.push_back(AffinityCalculator::calculateAffinityOfMask(strategy, *mask, text));
+    }
+    if (masks.size() == 1) {
+        return 0;
+    }
+    const int best = *std::max_element(affinities.begin() + 1, affinities.end());
+    if (affinities[0] >= best) {
+        return 0;
+    }
+    return static_cast<size_t>(std::find(affinities.begin() + 1, affinities.end(), best) - affinities.begin());
+}
+
+TEST(MaskSetTest, PrefixStrategyPicksTheMatchingCountryCode) {
+    MaskSet set(masksOf({"+7 ([000]) [000]-[00]-[00]", "8 ([000]) [000]-[00]-[00]"}));
+
+    const Result &russian = set.apply(CaretString("+7 12 345", 9, forward(true)), AffinityCalculationStrategy::PREFIX);
+    EXPECT_EQ(set.winnerIndex(), 0u);
+    EXPECT_EQ(russian.formattedText.string, "+7 (123) 45");
+    // 公共前缀分别为 "+7 " 与 ""
+    EXPECT_EQ(set.candidateAffinities(), (std::vector<int>{3, 0}));
+
+    const Result &local = set.apply(CaretString("8 12 345", 8, forward(true)), AffinityCalculationStrategy::PREFIX);
+    EXPECT_EQ(set.winnerIndex(), 1u);
+    EXPECT_EQ(local.formattedText.string, "8 (123) 45");
+    EXPECT_EQ(set.candidateAffinities(), (std::vector<int>{0, 2}));
+}
+
+TEST(MaskSetTest, CapacityStrategyFollowsTheDocumentedTable) {
+    MaskSet set(masksOf({"[00]-[0]", "[00]-[000]", "[00]-[00000]"}));
+    const CaretString text("12345", 5, forward(false));
+    set.apply(text, AffinityCalculationStrategy::CAPACITY);
+    EXPECT_EQ(set.candidateAffinities(), (std::vector<int>{std::numeric_limits<int>::min(), -1, -3}));
+    EXPECT_EQ(set.winnerIndex(), 1u);
+    EXPECT_EQ(set.winnerMask()->apply(text).formattedText.string, "12-345");
+}
+
+TEST(MaskSetTest, ExtractedValueCapacityStrategyPrefersAFilledPrimary) {
+    MaskSet set(masksOf({"[00]-[0]", "[00]-[000]", "[00]-[00000]"}));
+    // primary 只提取出 "123"，恰好填满
+    set.apply(CaretString("1234", 4, forward(false)), AffinityCalculationStrategy::EXTRACTED_VALUE_CAPACITY);
+    EXPECT_EQ(set.candidateAffinities(), (std::vector<int>{0, -1, -3}));
+    EXPECT_EQ(set.winnerIndex(), 0u);
+
+    set.apply(CaretString("12", 2, forward(false)), AffinityCalculationStrategy::EXTRACTED_VALUE_CAPACITY);
+    EXPECT_EQ(set.candidateAffinities(), (std::vector<int>{-1, -3, -5}));
+    EXPECT_EQ(set.winnerIndex(), 0u);
+}
+
+// 随机输入与编辑序列：胜者、各候选亲和度与结果都必须与逐个计算的基线规则一致
+TEST(MaskSetTest, RandomInputMatchesReferenceSelection) {
+    const std::vector<std::string> pool = {
+        "+7 ([000]) [000]-[00]-[00]", "8 ([000]) [000]-[00]-[00]", "+380 ([00]) [000] [00] [00]",
+        "[00]-[0]",                   "[00]-[000]",                "[00]-[00000]",
+        "[0000] [0000] [0000] [0000]", "[AAA] [000]",              "[00].[00]",
+        "[099]{.}[99]",               "[…]",                       "+1 ([000]) [000]-[0000]",
+    };
+    const std::string alphabet = "0123456789+-() .ab";
+    std::mt19937 random(7);
+    for (int iteration = 0; iteration < 2000; ++iteration) {
+        const bool rightToLeft = random() % 4 == 0;
+        std::vector<std::string> formats;
+        const size_t count = 1 + random() % 5;
+        for (size_t i = 0; i < count; ++i) {
+            formats.push_back(pool[random() % pool.size()]);
+        }
+        const auto masks = masksOf(formats, rightToLeft);
+        const auto strategy = static_cast<AffinityCalculationStrategy>(random() % 4);
+        MaskSet set(masks);
+        std::string text;
+        for (int step = 0; step < 20; ++step) {
+            if (!text.empty() && random() % 3 == 0) {
+                text.pop_back();
+            } else {
+                text += alphabet[random() % alphabet.length()];
+            }
+            const CaretString input(text, static_cast<int>(text.length()),
+                                    random() % 2 != 0 ? forward(random() % 2 != 0) : backward(random() % 2 != 0));
+            const Result &result = set.apply(input, strategy);
+
+            std::vector<int> affinities;
+            const size_t expected = referenceWinner(masks, strategy, input, affinities);
+            const std::string context = formats[0] + " x" + std::to_string(count) + " '" + text + "'";
+            ASSERT_EQ(set.winnerIndex(), expected) << context;
+            if (count > 1) {
+                ASSERT_EQ(set.candidateAffinities(), affinities) << context;
+            }
+            expectSameResult(result, masks[expected]->apply(input), context);
+            if (HasFailure()) {
+                return;
+            }
+        }
+    }
+}
+
+} // namespace
+} // namespace TinpMask
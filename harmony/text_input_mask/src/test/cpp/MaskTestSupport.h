@@ -0,0 +1,46 @@
+#pragma once
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "common/Mask.h"
+
+namespace TinpMask {
+namespace test {
+
+inline std::shared_ptr<CaretString::CaretGravity> forward(bool autocomplete) {
+    return std::make_shared<CaretString::Forward>(autocomplete);
+}
+
+inline std::shared_ptr<CaretString::CaretGravity> backward(bool autoskip) {
+    return std::make_shared<CaretString::Backward>(autoskip);
+}
+
+// 随机选取重力种类与标志
+inline std::shared_ptr<CaretString::CaretGravity> randomGravity(std::mt19937 &random) {
+    const bool flag = random() % 2 != 0;
+    return random() % 2 != 0 ? forward(flag) : backward(flag);
+}
+
+inline std::string randomText(std::mt19937 &random, const std::string &alphabet, size_t maxLength) {
+    std::string text;
+    const size_t length = random() % (maxLength + 1);
+    for (size_t i = 0; i < length; ++i) {
+        text += alphabet[random() % alphabet.length()];
+    }
+    return text;
+}
+
+// 逐项比较两个 Result，失败信息带上 context
+inline void expectSameResult(const Result &actual, const Result &expected, const std::string &context) {
+    EXPECT_EQ(actual.formattedText.string, expected.formattedText.string) << context;
+    EXPECT_EQ(actual.formattedText.caretPosition, expected.formattedText.caretPosition) << context;
+    EXPECT_EQ(actual.extractedValue, expected.extractedValue) << context;
+    EXPECT_EQ(actual.affinity, expected.affinity) << context;
+    EXPECT_EQ(actual.complete, expected.complete) << context;
+    EXPECT_EQ(actual.tailPlaceholder, expected.tailPlaceholder) << context;
+}
+
+} // namespace test
+} // namespace TinpMask
@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <gtest/gtest.h>
+#include "common/Mask.h"
+#include "common/ProgramStore.h"
+#include "MaskTestSupport.h"
+
+namespace TinpMask {
+namespace {
+
+using test::expectSameResult;
+
+// 读出运行时编译的程序，或直接以存储中的程序构造掩码
+class StoredMask : public Mask {
+public:
+    StoredMask(const std::string &format, const std::vector<Notation> &notations) : Mask(format, notations) {}
+    StoredMask(const std::string &format, const ProgramView &code) : Mask(std::string_view(format), code) {}
+
+    const Program &compiled() const { return program; }
+};
+
+const std::vector<Notation> Notations = {Notation('#', "abcdef0123456789", false), Notation('?', "xyz", true)};
+
+std::string pathOf(const std::string &name) { return testing::TempDir() + "text_input_mask_" + name + ".bin"; }
+
+std::string readFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string &path, const std::string &bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+std::vector<std::string> randomFormats(size_t count) {
+    const std::vector<std::string> alphabet = {"[", "]", "{", "}", "0", "9", "A", "a", "_", "-", "+",
+                                               " ", "(", ")", ".", "\xE2\x80\xA6", "x", "1", "#", "?"};
+    std::mt19937 random(7);
+    std::vector<std::string> formats = {"+7 ([000]) [000]-[00]-[00]", "{IBAN }[00] [0000] [0000][…]",
+                                        "[##]:[##]:[##]", "[00]{.}[99]"};
+    while (formats.size() < count) {
+        std::string format;
+        const size_t length = 2 + random() % 20;
+        for (size_t i = 0; i < length; ++i) {
+            format += alphabet[random() % alphabet.size()];
+        }
+        if (Mask::MaskFactory::isValid(format, Notations)) {
+            formats.push_back(format);
+        }
+    }
+    return formats;
+}
+
+// 写出一批程序，返回写入的格式
+std::vector<std::string> writeStore(const std::string &path) {
+    std::remove(path.c_str());
+    const std::vector<std::string> formats = randomFormats(200);
+    ProgramStore writer;
+    for (const std::string &format : formats) {
+        StoredMask mask(format, Notations);
+        writer.record(MaskCache::key(format, Notations, false), mask.compiled());
+    }
+    EXPECT_TRUE(writer.write(path));
+    return formats;
+}
+
+template <typename T> bool sameBytes(const T *stored, const T *compiled, size_t count) {
+    return std::memcmp(stored, compiled, count * sizeof(T)) == 0;
+}
+
+TEST(ProgramStoreTest, RoundTripKeepsProgramsAndResults) {
+    const std::string path = pathOf("round_trip");
+    const std::vector<std::string> formats = writeStore(path);
+
+    ProgramStore reader;
+    ASSERT_TRUE(reader.open(path));
+    std::mt19937 random(11);
+    for (const std::string &format : formats) {
+        ProgramView stored;
+        ASSERT_TRUE(reader.find(MaskCache::key(format, Notations, false), stored)) << format;
+        StoredMask fresh(format, Notations);
+        const ProgramView compiled = fresh.compiled().view();
+
+        // 表逐字节一致
+        ASSERT_EQ(stored.instructionCount, compiled.instructionCount) << format;
+        EXPECT_EQ(stored.autocompletableCount, compiled.autocompletableCount) << format;
+        EXPECT_TRUE(sameBytes(stored.instructions, compiled.instructions, compiled.instructionCount)) << format;
+        EXPECT_TRUE(sameBytes(stored.suffixes, compiled.suffixes, compiled.instructionCount)) << format;
+        EXPECT_TRUE(sameBytes(stored.placeholders, compiled.placeholders, compiled.instructionCount - 1)) << format;
+
+        // 从映射区直接执行的结果与重新编译的一致
+        StoredMask mapped(format, stored);
+        EXPECT_EQ(mapped.placeholder(), fresh.placeholder()) << format;
+        EXPECT_EQ(mapped.totalValueLength(), fresh.totalValueLength()) << format;
+        for (int i = 0; i < 20; ++i) {
+            const std::string text = test::randomText(random, "0123456789abcXYZxyz +-().", 16);
+            const CaretString input(text, static_cast<int>(random() % (text.length() + 1)),
+                                    test::randomGravity(random));
+            expectSameResult(mapped.apply(input), fresh.apply(input), format + " '" + text + "'");
+        }
+        if (HasFailure()) {
+            return;
+        }
+    }
+    ProgramView missing;
+    EXPECT_FALSE(reader.find(MaskCache::key("[000]-never-recorded", Notations, false), missing));
+    std::remove(path.c_str());
+}
+
+TEST(ProgramStoreTest, KnownFormatFromStore) {
+    const std::string path = pathOf("known");
+    writeStore(path);
+    ProgramStore reader;
+    ASSERT_TRUE(reader.open(path));
+    ProgramView stored;
+    ASSERT_TRUE(reader.find(MaskCache::key("+7 ([000]) [000]-[00]-[00]", Notations, false), stored));
+    StoredMask mask("+7 ([000]) [000]-[00]-[00]", stored);
+    const Result result = mask.apply(CaretString("9123456789", 10, test::forward(true)));
+    EXPECT_EQ(result.formattedText.string, "+7 (912) 345-67-89");
+    EXPECT_EQ(result.extractedValue, "9123456789");
+    EXPECT_TRUE(result.complete);
+    std::remove(path.c_str());
+}
+
+TEST(ProgramStoreTest, RejectsDamagedFiles) {
+    const std::string path = pathOf("damaged");
+    writeStore(path);
+    const std::string original = readFile(path);
+    ASSERT_GT(original.size(), 64u);
+
+    std::string flipped = original;
+    flipped[original.size() / 2] ^= 0x5A;
+    writeFile(path, flipped);
+    EXPECT_FALSE(ProgramStore().open(path)) << "checksum";
+
+    std::string otherVersion = original;
+    otherVersion[4] ^= 0x01; // FileHeader::version 紧跟 4 字节 magic
+    writeFile(path, otherVersion);
+    EXPECT_FALSE(ProgramStore().open(path)) << "version";
+
+    writeFile(path, original.substr(0, original.size() - 8));
+    EXPECT_FALSE(ProgramStore().open(path)) << "truncated";
+
+    writeFile(path, original);
+    EXPECT_TRUE(ProgramStore().open(path));
+    std::remove(path.c_str());
+    EXPECT_FALSE(ProgramStore().open(path)) << "missing";
+}
+
+} // namespace
+} // namespace TinpMask
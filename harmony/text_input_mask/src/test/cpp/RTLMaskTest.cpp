@@ -0,0 +1,121 @@
+#include <random>
+#include <gtest/gtest.h>
+#include "common/ApplySession.h"
+#include "common/RTLMask.h"
+#include "MaskTestSupport.h"
+
+namespace TinpMask {
+namespace {
+
+using test::backward;
+using test::expectSameResult;
+using test::forward;
+
+const std::vector<Notation> Notations = {Notation('d', "0123456789", false), Notation('D', "ABCDEF", true)};
+
+// 原有实现：反转输入，用反转后的格式正向 apply，再反转结果；两种重力都按原样传入
+Result reference(const std::string &format, const CaretString &text) {
+    Mask mask(RTLMask::reversedFormat(format), Notations);
+    return mask.apply(text.reversed()).reversed();
+}
+
+std::string randomFormat(std::mt19937 &random) {
+    const std::vector<std::string> fixed = {"+7 ([000]) [000]-[00]-[00]", "[0000] [0000] [0000] [0000]",
+                                            "[00]{.}[00]{.}[0000]", "[09]{.}[09]", "[AAA]-[000]",
+                                            "[000] [000] [000]", "[0]{.}[00]{ }[…]"};
+    const std::vector<std::string> tokens = {"[0]", "[00]", "[000]", "[9]", "[99]", "[A]", "[a]", "[_]",
+                                             "[-]", "[0009]", "[AAaa]", "{.}", "{-}", "{ }", "+7 ", "(",
+                                             ")", " ", "-", "\\[", "\\{", "[d]", "[D]", "[0A]"};
+    if (random() % 3 == 0) {
+        return fixed[random() % fixed.size()];
+    }
+    std::string format;
+    const size_t count = 1 + random() % 6;
+    for (size_t i = 0; i < count; ++i) {
+        format += tokens[random() % tokens.size()];
+    }
+    return format;
+}
+
+TEST(RTLMaskTest, FormatsFromTheRight) {
+    RTLMask mask("[000] [000] [000]", Notations);
+
+    const Result &typed = mask.apply(CaretString("1234567", 7, forward(true)));
+    EXPECT_EQ(typed.formattedText.string, "1 234 567");
+    EXPECT_EQ(typed.formattedText.caretPosition, 9);
+    EXPECT_EQ(typed.extractedValue, "1234567");
+    EXPECT_FALSE(typed.complete);
+
+    const Result &deleted = mask.apply(CaretString("1234", 4, backward(false)));
+    EXPECT_EQ(deleted.formattedText.string, "1 234");
+    EXPECT_EQ(deleted.formattedText.caretPosition, 5);
+    EXPECT_EQ(deleted.extractedValue, "1234");
+}
+
+TEST(RTLMaskTest, CaretFollowsGravityAtAnInsertedSpace) {
+    RTLMask mask("[000] [000]", Notations);
+    // 光标在 "1" 之后：Forward 停在插入的空格之前，Backward 越过空格
+    EXPECT_EQ(mask.apply(CaretString("1234", 1, forward(false))).formattedText.caretPosition, 1);
+    EXPECT_EQ(mask.apply(CaretString("1234", 1, backward(false))).formattedText.caretPosition, 2);
+}
+
+TEST(RTLMaskTest, ReversedFormatSwapsBrackets) {
+    EXPECT_EQ(RTLMask::reversedFormat("[000] [00]"), "[00] [000]");
+    EXPECT_EQ(RTLMask::reversedFormat("{+7} [0]"), "[0] {7+}");
+    EXPECT_EQ(RTLMask::reversedFormat("[00]…"), "…[00]");
+}
+
+TEST(RTLMaskTest, RandomInputsMatchReversedForwardApply) {
+    std::mt19937 random(17);
+    const std::string alphabet = "0123456789abcAB-_.() +7[]{}\\xyz";
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        const std::string format = randomFormat(random);
+        if (!Mask::MaskFactory::isValid(format, Notations)) {
+            continue;
+        }
+        const std::string text = test::randomText(random, alphabet, 14);
+        const int caret = random() % 3 == 0 ? static_cast<int>(random() % (text.length() + 1))
+                                            : static_cast<int>(text.length());
+        const CaretString input(text, caret, test::randomGravity(random));
+        RTLMask mask(format, Notations);
+        expectSameResult(mask.apply(input), reference(format, input), format + " '" + text + "'");
+        if (HasFailure()) {
+            return;
+        }
+    }
+}
+
+TEST(RTLMaskTest, SessionMatchesReversedForwardApply) {
+    std::mt19937 random(23);
+    const std::string alphabet = "0123456789AB -";
+    for (int sequence = 0; sequence < 500; ++sequence) {
+        const std::string format = randomFormat(random);
+        if (!Mask::MaskFactory::isValid(format, Notations)) {
+            continue;
+        }
+        RTLMask mask(format, Notations);
+        ApplySession session;
+        std::string text;
+        for (int step = 0; step < 20; ++step) {
+            // 在随机位置插入或删除一个字符
+            const size_t position = random() % (text.length() + 1);
+            const bool insert = text.empty() || random() % 3 != 0;
+            if (insert) {
+                text.insert(position, 1, alphabet[random() % alphabet.length()]);
+            } else {
+                text.erase(std::min(position, text.length() - 1), 1);
+            }
+            const CaretString input(text, static_cast<int>(std::min(position + 1, text.length())),
+                                    insert ? forward(random() % 2 != 0) : backward(random() % 2 != 0));
+            const Result &result = mask.apply(input, session);
+            expectSameResult(result, reference(format, input), format + " '" + text + "'");
+            if (HasFailure()) {
+                return;
+            }
+            text = result.formattedText.string;
+        }
+    }
+}
+
+} // namespace
+} // namespace TinpMask
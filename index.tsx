@@ -11,7 +11,17 @@ import { findNodeHandle, Platform, TextInput, TextInputProps } from 'react-nativ
 import exportMasker from './src/index'
 export const mask = exportMasker.mask
 export const unmask = exportMasker.unmask
+export const maskSync = exportMasker.maskSync
+export const unmaskSync = exportMasker.unmaskSync
+export const compileMask = exportMasker.compileMask
+export const trimMaskCache = exportMasker.trimMaskCache
+export const maskCacheStats = exportMasker.maskCacheStats
+export const persistMaskCache = exportMasker.persistMaskCache
+export const prewarmMasks = exportMasker.prewarmMasks
+export const maskBatch = exportMasker.maskBatch
+export const unmaskBatch = exportMasker.unmaskBatch
 export const setMask = exportMasker.setMask
+export const unsetMask = exportMasker.unsetMask
 const TextInputMask = forwardRef<Handles, TextInputMaskProps>(({
     mask: primaryFormat,
     defaultValue,
@@ -24,9 +34,11 @@ const TextInputMask = forwardRef<Handles, TextInputMaskProps>(({
     autocomplete= true,
     autoskip = true,
     rightToLeft,
+    asyncFormatting,
     ...rest
 }, ref) => {
   const input = useRef<TextInput>(null)
+  const maskedNode = useRef<number | null>(null)
   const [ maskedValue, setMaskedValue ] = useState<string>()
 
   useEffectAsync(async () => {
@@ -53,10 +65,17 @@ const TextInputMask = forwardRef<Handles, TextInputMaskProps>(({
   useEffect(() => {
     const nodeId = findNodeHandle(input.current)
     if (primaryFormat && nodeId) {
-      setMask(nodeId, primaryFormat, { affineFormats, affinityCalculationStrategy, customNotations, autocomplete, autoskip, rightToLeft })
+      setMask(nodeId, primaryFormat, { affineFormats, affinityCalculationStrategy, customNotations, autocomplete, autoskip, rightToLeft, asyncFormatting })
+      maskedNode.current = nodeId
     }
   }, [primaryFormat])
 
+  useEffect(() => () => {
+    if (maskedNode.current !== null) {
+      unsetMask(maskedNode.current)
+    }
+  }, [])
+
   useImperativeHandle(ref, () => ({
     focus: () => {
       input.current?.focus()
@@ -107,6 +126,11 @@ interface MaskOptions {
    */
   autoskip?: boolean
   rightToLeft?: boolean
+  /**
+   * HarmonyOS: format edits on a background thread and apply the result on the UI thread.
+   * Worth it for large `affineFormats` sets or long elliptical input; results of superseded edits are dropped.
+   */
+  asyncFormatting?: boolean
 }
 
 type AffinityCalculationStrategy =
@@ -217,7 +241,13 @@ interface Notation {
   /**
    * Is it an optional symbol or mandatory?
    */
-  isOptional: boolean
+  isOptional: boolean,
+  /**
+   * Read `from-to` in ```characterSet``` as a range, e.g. `a-zA-Z0-9`. Defaults to `false`: every
+   * character, `-` included, stands for itself. A leading or trailing `-` is always literal.
+   * Only honoured on HarmonyOS.
+   */
+  characterRanges?: boolean
 }
 
 export interface TextInputMaskProps extends TextInputProps, MaskOptions{
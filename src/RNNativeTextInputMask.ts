@@ -14,6 +14,11 @@ export interface MaskOptions {
      */
     autoskip?: boolean
     rightToLeft?: boolean
+    /**
+     * HarmonyOS: format edits of a `setMask` field on a background thread and apply the result on the UI thread.
+     * Worth it for large `affineFormats` sets or long elliptical input; results of superseded edits are dropped.
+     */
+    asyncFormatting?: boolean
   }
 
   export type AffinityCalculationStrategy =
@@ -124,13 +129,103 @@ interface Notation {
   /**
    * Is it an optional symbol or mandatory?
    */
-  isOptional: boolean
+  isOptional: boolean,
+  /**
+   * Read `from-to` in ```characterSet``` as a range, e.g. `a-zA-Z0-9`. Defaults to `false`: every
+   * character, `-` included, stands for itself. A leading or trailing `-` is always literal.
+   */
+  characterRanges?: boolean
+}
+
+/**
+ * Mask compiled once by ```compileMask```. The native mask is released when the handle is garbage collected.
+ */
+export interface CompiledMask {
+  /**
+   * Format the value. `autocomplete` defaults to the option passed to ```compileMask```.
+   */
+  apply(value: string, autocomplete?: boolean): string
+  /**
+   * Extract the value. `autocomplete` defaults to the option passed to ```compileMask```.
+   */
+  unmask(value: string, autocomplete?: boolean): string
+  placeholder(): string
+  /**
+   * Minimal length of the text inside the field to fill all mandatory characters in the mask.
+   */
+  acceptableTextLength(): number
+  /**
+   * Maximal length of the extracted value.
+   */
+  totalValueLength(): number
+}
+
+/**
+ * Counters of the native compiled-mask cache.
+ */
+export interface MaskCacheStats {
+  hits: number
+  misses: number
+  evictions: number
+  /**
+   * Approximate memory held by cached masks.
+   */
+  bytes: number
+  entries: number
 }
 
+/**
+ * Values for ```maskBatch``` / ```unmaskBatch``` packed into a single buffer.
+ *
+ * Layout, all integers are little-endian uint32:
+ * ```
+ * count | offsets[count + 1] | UTF-8 bytes
+ * ```
+ * Offsets are relative to the start of the byte area; value `i` spans `offsets[i]..offsets[i + 1]`.
+ * Results are returned in the same layout.
+ */
+export type PackedValues = ArrayBuffer
+
 export interface Spec extends TurboModule {
     mask (mask: string, value: string, autocomplete: boolean) :Promise<string>, 
     unmask (mask: string, value: string, autocomplete: boolean): Promise<string>, 
+    /**
+     * Synchronous variant of ```mask```. `customNotations` are the notations used by the format, as in
+     * ```MaskOptions```. Returns `null` if the format is malformed.
+     */
+    maskSync (mask: string, value: string, autocomplete: boolean, customNotations?: Notation[]): string | null,
+    /**
+     * Synchronous variant of ```unmask```. `customNotations` are the notations used by the format, as in
+     * ```MaskOptions```. Returns `null` if the format is malformed.
+     */
+    unmaskSync (mask: string, value: string, autocomplete: boolean, customNotations?: Notation[]): string | null,
+    /**
+     * Compile a mask for repeated use. Returns `null` if the format is malformed.
+     */
+    compileMask (mask: string, options?: MaskOptions): CompiledMask | null,
+    /**
+     * Drop cached compiled masks, keeping at most `targetBytes` (default 0). Call it on memory-pressure signals.
+     */
+    trimMaskCache (targetBytes?: number): void,
+    maskCacheStats (): MaskCacheStats,
+    /**
+     * Write the masks compiled so far to the on-disk cache, so the next start maps them instead of compiling.
+     * Returns `false` if the file could not be written or the app has no cache directory.
+     */
+    persistMaskCache (): boolean,
+    /**
+     * Compile `formats` on a background thread ahead of use. Resolves with the number of masks ready in the cache;
+     * malformed formats are skipped. `setMask` does this automatically for its primary and affine formats.
+     */
+    prewarmMasks (formats: string[], options?: MaskOptions): Promise<number>,
+    maskBatch (mask: string, values: string[] | PackedValues, options?: MaskOptions): Promise<string[] | PackedValues>,
+    unmaskBatch (mask: string, values: string[] | PackedValues, options?: MaskOptions): Promise<string[] | PackedValues>,
     setMask (reactNode: number, primaryFormat: string, options?: MaskOptions): void;
+    /**
+     * Detach the mask bound by `setMask` from `reactNode` and release its native state. Calling `setMask` again
+     * on a bound node updates it in place; bindings of destroyed inputs are released automatically.
+     */
+    unsetMask (reactNode: number): void;
 }
 
 export default TurboModuleRegistry.get<Spec>('RNTextInputMask') as Spec ;
\ No newline at end of file
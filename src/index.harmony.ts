@@ -1,4 +1,5 @@
-import RNNativeTextInputMask from './RNNativeTextInputMask';
+import RNNativeTextInputMask, { CompiledMask, MaskCacheStats, PackedValues } from './RNNativeTextInputMask';
+export type { CompiledMask, MaskCacheStats, PackedValues } from './RNNativeTextInputMask';
 export interface MaskOptions {
     affineFormats?: string[];
     customNotations?: Notation[];
@@ -12,6 +13,11 @@ export interface MaskOptions {
      */
     autoskip?: boolean;
     rightToLeft?: boolean;
+    /**
+     * HarmonyOS: format edits of a `setMask` field on a background thread and apply the result on the UI thread.
+     * Worth it for large `affineFormats` sets or long elliptical input; results of superseded edits are dropped.
+     */
+    asyncFormatting?: boolean;
 }
 
 type AffinityCalculationStrategy = 
@@ -119,6 +125,11 @@ interface Notation {
      * Is it an optional symbol or mandatory?
      */
     isOptional: boolean;
+    /**
+     * Read `from-to` in ```characterSet``` as a range, e.g. `a-zA-Z0-9`. Defaults to `false`: every
+     * character, `-` included, stands for itself. A leading or trailing `-` is always literal.
+     */
+    characterRanges?: boolean;
 }
 
 
@@ -130,9 +141,86 @@ class HarmonyTextInputMask {
     static unmask(mask: string, value: string, autocomplete: boolean): Promise<string> {
         return RNNativeTextInputMask.unmask(mask, value, autocomplete);
     }
+    /**
+     * Format a value without going through a Promise. Pass `customNotations` if the format uses them.
+     * Returns `null` if the format is malformed.
+     */
+    static maskSync(mask: string, value: string, autocomplete: boolean, customNotations?: Notation[]): string | null {
+        return RNNativeTextInputMask.maskSync(mask, value, autocomplete, customNotations);
+    }
+
+    /**
+     * Extract a value without going through a Promise. Pass `customNotations` if the format uses them.
+     * Returns `null` if the format is malformed.
+     */
+    static unmaskSync(mask: string, value: string, autocomplete: boolean, customNotations?: Notation[]): string | null {
+        return RNNativeTextInputMask.unmaskSync(mask, value, autocomplete, customNotations);
+    }
+
+    /**
+     * Compile a mask once for repeated formatting. Returns `null` if the format is malformed.
+     *
+     * Only `customNotations`, `rightToLeft` and `autocomplete` are taken from `options`.
+     */
+    static compileMask(mask: string, options?: MaskOptions): CompiledMask | null {
+        return RNNativeTextInputMask.compileMask(mask, options);
+    }
+
+    /**
+     * Release cached compiled masks, e.g. from an `onMemoryLevel` handler. Masks bound to fields stay alive.
+     */
+    static trimMaskCache(targetBytes?: number): void {
+        RNNativeTextInputMask.trimMaskCache(targetBytes);
+    }
+
+    static maskCacheStats(): MaskCacheStats {
+        return RNNativeTextInputMask.maskCacheStats();
+    }
+
+    /**
+     * Save compiled masks to the app cache directory, e.g. once dynamic formats are loaded or when the app goes
+     * to the background. The next start maps the file instead of compiling those formats again.
+     */
+    static persistMaskCache(): boolean {
+        return RNNativeTextInputMask.persistMaskCache();
+    }
+
+    /**
+     * Compile formats on a background thread so that the first keystroke does not pay for it, e.g. right after
+     * loading formats from a server config. Resolves with the number of masks ready; malformed formats are skipped.
+     *
+     * Only `customNotations` and `rightToLeft` are taken from `options`.
+     */
+    static prewarmMasks(formats: string[], options?: MaskOptions): Promise<number> {
+        return RNNativeTextInputMask.prewarmMasks(formats, options);
+    }
+
+    /**
+     * Format many values with one compiled mask in a single native call.
+     *
+     * `options.autocomplete` defaults to `true`; `affineFormats` are matched per value.
+     */
+    static maskBatch(mask: string, values: string[], options?: MaskOptions): Promise<string[]>;
+    static maskBatch(mask: string, values: PackedValues, options?: MaskOptions): Promise<PackedValues>;
+    static maskBatch(mask: string, values: string[] | PackedValues, options?: MaskOptions): Promise<string[] | PackedValues> {
+        return RNNativeTextInputMask.maskBatch(mask, values, options);
+    }
+
+    /**
+     * Extract the values of many masked strings in a single native call.
+     */
+    static unmaskBatch(mask: string, values: string[], options?: MaskOptions): Promise<string[]>;
+    static unmaskBatch(mask: string, values: PackedValues, options?: MaskOptions): Promise<PackedValues>;
+    static unmaskBatch(mask: string, values: string[] | PackedValues, options?: MaskOptions): Promise<string[] | PackedValues> {
+        return RNNativeTextInputMask.unmaskBatch(mask, values, options);
+    }
     static  setMask(reactNode: number, primaryFormat: string, options?: MaskOptions): void {
         RNNativeTextInputMask.setMask(reactNode, primaryFormat, options)
     }
+
+    static unsetMask(reactNode: number): void {
+        RNNativeTextInputMask.unsetMask(reactNode)
+    }
 }
 console.log("======HarmonyTextInputMask=",HarmonyTextInputMask)
 export default HarmonyTextInputMask;
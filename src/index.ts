@@ -1,11 +1,23 @@
-import HarmonyTextInputMask ,{MaskOptions}from './index.harmony'
+import HarmonyTextInputMask ,{CompiledMask, MaskCacheStats, MaskOptions, PackedValues}from './index.harmony'
 import {mask as maskA, unmask as unmaskA, setMask as setMaskA }  from 'react-native-text-input-mask';
 import { Platform } from 'react-native';
 
 interface MaskOperations {
     mask(mask: string, value: string, autocomplete: boolean): Promise<string> ;
     unmask(mask: string, value: string, autocomplete: boolean): Promise<string> 
+    maskSync(mask: string, value: string, autocomplete: boolean, customNotations?: MaskOptions['customNotations']): string | null
+    unmaskSync(mask: string, value: string, autocomplete: boolean, customNotations?: MaskOptions['customNotations']): string | null
+    compileMask(mask: string, options?: MaskOptions): CompiledMask | null
+    trimMaskCache(targetBytes?: number): void
+    maskCacheStats(): MaskCacheStats | null
+    persistMaskCache(): boolean
+    prewarmMasks(formats: string[], options?: MaskOptions): Promise<number>
+    maskBatch(mask: string, values: string[], options?: MaskOptions): Promise<string[]>
+    maskBatch(mask: string, values: PackedValues, options?: MaskOptions): Promise<PackedValues>
+    unmaskBatch(mask: string, values: string[], options?: MaskOptions): Promise<string[]>
+    unmaskBatch(mask: string, values: PackedValues, options?: MaskOptions): Promise<PackedValues>
     setMask(reactNode: number, primaryFormat: string, options?: MaskOptions): void
+    unsetMask(reactNode: number): void
 }
 const isIosAndroid = Platform.OS === 'ios' || Platform.OS === 'android';
 
@@ -19,9 +31,59 @@ constructor(){}
         static unmask(mask: string, value: string, autocomplete: boolean): Promise<string> {
             return unmaskA(mask, value, autocomplete);
         }
+        // iOS/Android 没有同步接口
+        static maskSync(mask: string, value: string, autocomplete: boolean): string | null {
+            throw new Error('maskSync is only supported on HarmonyOS');
+        }
+
+        static unmaskSync(mask: string, value: string, autocomplete: boolean): string | null {
+            throw new Error('unmaskSync is only supported on HarmonyOS');
+        }
+
+        static compileMask(mask: string, options?: MaskOptions): CompiledMask | null {
+            throw new Error('compileMask is only supported on HarmonyOS');
+        }
+
+        // iOS/Android 的掩码缓存由原生库自行管理
+        static trimMaskCache(targetBytes?: number): void {}
+
+        static maskCacheStats(): MaskCacheStats | null {
+            return null;
+        }
+
+        static persistMaskCache(): boolean {
+            return false;
+        }
+
+        // iOS/Android 在首次使用时编译，无需预热
+        static prewarmMasks(formats: string[], options?: MaskOptions): Promise<number> {
+            return Promise.resolve(0);
+        }
+
+        // iOS/Android 没有批量接口，逐个调用；不支持打包的 ArrayBuffer
+        static maskBatch(mask: string, values: string[], options?: MaskOptions): Promise<string[]>;
+        static maskBatch(mask: string, values: PackedValues, options?: MaskOptions): Promise<PackedValues>;
+        static maskBatch(mask: string, values: string[] | PackedValues, options?: MaskOptions): Promise<any> {
+            if (!Array.isArray(values)) {
+                return Promise.reject(new Error('maskBatch: packed values are only supported on HarmonyOS'));
+            }
+            return Promise.all(values.map(value => maskA(mask, value, options?.autocomplete ?? true)));
+        }
+
+        static unmaskBatch(mask: string, values: string[], options?: MaskOptions): Promise<string[]>;
+        static unmaskBatch(mask: string, values: PackedValues, options?: MaskOptions): Promise<PackedValues>;
+        static unmaskBatch(mask: string, values: string[] | PackedValues, options?: MaskOptions): Promise<any> {
+            if (!Array.isArray(values)) {
+                return Promise.reject(new Error('unmaskBatch: packed values are only supported on HarmonyOS'));
+            }
+            return Promise.all(values.map(value => unmaskA(mask, value, options?.autocomplete ?? true)));
+        }
         static  setMask(reactNode: number, primaryFormat: string, options?: MaskOptions): void {
         setMaskA(reactNode, primaryFormat, options)
         }
+
+        // iOS/Android 的绑定随原生输入框一起释放
+        static unsetMask(reactNode: number): void {}
 }
 console.log("======isIosAndroid=",isIosAndroid)
 console.log("======RNTextInputMask=",RNTextInputMask)